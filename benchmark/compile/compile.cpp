@@ -0,0 +1,386 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+/**
+ * Compile-time benchmark
+ *
+ * Generates synthetic interfaces, SUTs and test files, compiles them with
+ * GUnit (GTEST/SHOULD/GMock) and plain gmock (TEST_F/MOCK_METHOD) and records
+ * compile time, peak compiler RSS and object size into a JSON report.
+ * The `gunit+pch` variant compiles the GUnit tests against a precompiled
+ * GUnit.h (built once, reported as `pch/GUnit.h`).
+ *
+ * compile_benchmark --cxx=<compiler> [--flag=<flag>]... [--out=report.json]
+ *                   [--work=<dir>] [--repeat=N] [--filter=<substring>]
+ *                   [--methods=N --args=N --tests=N --shoulds=N --names=N]
+ */
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct scenario {
+  std::string name{};
+  int methods{};  // virtual methods per interface
+  int args{};     // SUT constructor arguments (one interface each)
+  int tests{};    // GTESTs/TEST_Fs per file
+  int shoulds{};  // SHOULDs per GTEST (one TEST_F each in gmock variant)
+  int names{};    // length of GTEST("names") (0 - GTEST(sut, "[test]"))
+};
+
+struct result {
+  scenario s{};
+  std::string variant{};
+  bool ok{};
+  double wall_ms{};
+  double cpu_ms{};
+  long peak_rss_kb{};
+  long object_size{};
+};
+
+struct options {
+  std::string cxx{"c++"};
+  std::vector<std::string> flags{};
+  std::string out{"compile_benchmark.json"};
+  std::string work{"compile_benchmark"};
+  std::string filter{};
+  int repeat{1};
+  scenario custom{"custom", 0, 0, 0, 0, 0};
+};
+
+std::vector<scenario> default_scenarios() {
+  // clang-format off
+  return {
+    {"interface/methods=10",  10,  2, 10, 1},
+    {"interface/methods=50",  50,  2, 10, 1},
+    {"interface/methods=200", 200, 2, 10, 1},
+    {"sut/args=2",            10,  2, 10, 1},
+    {"sut/args=5",            10,  5, 10, 1},
+    {"sut/args=10",           10, 10, 10, 1},
+    {"sut/args=20",           10, 20, 10, 1},
+    {"tests/tests=10",        10,  2, 10, 1},
+    {"tests/tests=100",       10,  2, 100, 1},
+    {"tests/tests=1000",      10,  2, 1000, 1},
+    {"shoulds/shoulds=10",    10,  2, 10, 10},
+    {"shoulds/shoulds=100",   10,  2, 10, 100},
+    {"names/tests=500",       10,  2, 500, 1, 80},
+  };
+  // clang-format on
+}
+
+void header(std::ostream& os, const scenario& s) {
+  for (auto i = 0; i < s.args; ++i) {
+    os << "struct i" << i << " {\n  virtual ~i" << i << "() = default;\n";
+    for (auto m = 0; m < s.methods; ++m) {
+      os << "  virtual int m" << m << "(int) = 0;\n";
+    }
+    os << "};\n";
+  }
+
+  os << "class sut {\n public:\n  sut(";
+  for (auto i = 0; i < s.args; ++i) {
+    os << (i ? ", " : "") << "i" << i << "& a" << i;
+  }
+  os << ")\n      : ";
+  for (auto i = 0; i < s.args; ++i) {
+    os << (i ? ", " : "") << "a" << i << "(a" << i << ")";
+  }
+  os << " {}\n  int run(int m, int x) {\n    switch (m) {\n";
+  for (auto m = 0; m < s.methods; ++m) {
+    os << "      case " << m << ": return a" << m % s.args << ".m" << m
+       << "(x);\n";
+  }
+  os << "    }\n    return 0;\n  }\n\n private:\n";
+  for (auto i = 0; i < s.args; ++i) {
+    os << "  i" << i << "& a" << i << ";\n";
+  }
+  os << "};\n";
+}
+
+std::string gunit(const scenario& s) {
+  std::stringstream os{};
+  os << "#include <GUnit.h>\n";
+  header(os, s);
+  for (auto t = 0, k = 0; t < s.tests; ++t) {
+    if (s.names) {
+      auto name = "should test sut " + std::to_string(t) + " ";
+      name.resize(std::max<std::size_t>(name.size(), s.names), '.');
+      os << "GTEST(\"" << name << "\") {\n"
+         << "  using namespace testing;\n"
+         << "  std::unique_ptr<::sut> sut;\n"
+         << "  std::tie(sut, mocks) = make<std::unique_ptr<::sut>, "
+            "StrictGMock>();\n";
+    } else {
+      os << "GTEST(sut, \"[test " << t << "]\") {\n"
+         << "  using namespace testing;\n";
+    }
+    for (auto sh = 0; sh < s.shoulds; ++sh, ++k) {
+      const auto m = k % s.methods;
+      os << "  SHOULD(\"call m" << m << " with " << k << "\") {\n"
+         << "    EXPECT_CALL(mock<i" << m % s.args << ">(), (m" << m << ")("
+         << k << ")).WillOnce(Return(" << k << "));\n"
+         << "    EXPECT_EQ(" << k << ", sut->run(" << m << ", " << k << "));\n"
+         << "  }\n";
+    }
+    os << "}\n";
+  }
+  return os.str();
+}
+
+std::string gmock(const scenario& s) {
+  std::stringstream os{};
+  os << "#include <gmock/gmock.h>\n#include <gtest/gtest.h>\n"
+     << "#include <memory>\n";
+  header(os, s);
+  for (auto i = 0; i < s.args; ++i) {
+    os << "struct mock_i" << i << " : i" << i << " {\n";
+    for (auto m = 0; m < s.methods; ++m) {
+      os << "  MOCK_METHOD(int, m" << m << ", (int), (override));\n";
+    }
+    os << "};\n";
+  }
+  os << "class sut_test : public testing::Test {\n public:\n";
+  for (auto i = 0; i < s.args; ++i) {
+    os << "  testing::StrictMock<mock_i" << i << "> m" << i << ";\n";
+  }
+  os << "  std::unique_ptr<sut> sut_ = std::make_unique<sut>(";
+  for (auto i = 0; i < s.args; ++i) {
+    os << (i ? ", " : "") << "m" << i;
+  }
+  os << ");\n};\n";
+  for (auto k = 0; k < s.tests * s.shoulds; ++k) {
+    const auto m = k % s.methods;
+    os << "TEST_F(sut_test, ShouldCallM" << m << "With" << k << ") {\n"
+       << "  using namespace testing;\n"
+       << "  EXPECT_CALL(m" << m % s.args << ", m" << m << "(" << k
+       << ")).WillOnce(Return(" << k << "));\n"
+       << "  EXPECT_EQ(" << k << ", sut_->run(" << m << ", " << k << "));\n"
+       << "}\n";
+  }
+  return os.str();
+}
+
+bool compile(const options& opt, const std::vector<std::string>& extra,
+             const std::string& obj, result& r) {
+  std::vector<std::string> args{opt.cxx};
+  args.insert(args.end(), opt.flags.begin(), opt.flags.end());
+  args.insert(args.end(), extra.begin(), extra.end());
+  args.insert(args.end(), {"-o", obj});
+  std::vector<char*> argv{};
+  for (auto& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  const auto begin = std::chrono::steady_clock::now();
+  const auto pid = fork();
+  if (pid == 0) {
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  if (pid < 0) {
+    return false;
+  }
+
+  int status{};
+  struct rusage usage {};
+  if (wait4(pid, &status, 0, &usage) < 0) {
+    return false;
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  r.wall_ms =
+      std::chrono::duration<double, std::milli>(end - begin).count();
+  r.cpu_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+             (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+#if defined(__APPLE__)
+  r.peak_rss_kb = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+  r.peak_rss_kb = usage.ru_maxrss;
+#endif
+  struct stat st {};
+  r.object_size = stat(obj.c_str(), &st) ? 0 : st.st_size;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+std::string pch_header(const options& opt) {
+  return opt.work + "/pch/GUnit.h";
+}
+
+result precompile(const options& opt) {
+  mkdir((opt.work + "/pch").c_str(), 0755);
+  std::ofstream{pch_header(opt)} << "#include <GUnit.h>\n";
+  result r{{"pch/GUnit.h"}, "pch"};
+  r.ok = compile(opt, {"-x", "c++-header", pch_header(opt)},
+                 pch_header(opt) + ".gch", r);
+  return r;
+}
+
+bool has_steps(const options& opt) {
+  const auto src = opt.work + "/steps.cpp";
+  std::ofstream{src} << "#if !__has_include(<json.hpp>) or "
+                        "!__has_include(<gherkin.hpp>)\n"
+                     << "#error GSteps is not available\n#endif\n";
+  result r{};
+  return compile(opt, {"-c", src}, opt.work + "/steps.o", r);
+}
+
+result run(const options& opt, const scenario& s, const std::string& variant) {
+  auto file = s.name + "_" + variant;
+  for (auto& c : file) {
+    c = std::isalnum(c) ? c : '_';
+  }
+  const auto src = opt.work + "/" + file + ".cpp";
+  const auto obj = opt.work + "/" + file + ".o";
+  std::ofstream{src} << (variant == "gmock" ? gmock(s) : gunit(s));
+
+  std::vector<std::string> args{"-c", src};
+  if (variant == "gunit+pch") {
+    args.insert(args.begin(), {"-include", pch_header(opt)});
+  }
+
+  result best{s, variant};
+  for (auto i = 0; i < opt.repeat; ++i) {
+    result r{s, variant};
+    r.ok = compile(opt, args, obj, r);
+    if (!i || (r.ok && r.wall_ms < best.wall_ms)) {
+      best = r;
+    }
+  }
+  return best;
+}
+
+void report(std::ostream& os, const options& opt,
+            const std::vector<result>& results) {
+  os << "{\n  \"compiler\": \"" << opt.cxx << "\",\n  \"flags\": [";
+  for (auto i = 0u; i < opt.flags.size(); ++i) {
+    os << (i ? ", " : "") << '"' << opt.flags[i] << '"';
+  }
+  os << "],\n  \"results\": [\n";
+  for (auto i = 0u; i < results.size(); ++i) {
+    const auto& r = results[i];
+    os << "    {\"scenario\": \"" << r.s.name << "\", \"variant\": \""
+       << r.variant << "\", \"methods\": " << r.s.methods
+       << ", \"args\": " << r.s.args << ", \"tests\": " << r.s.tests
+       << ", \"shoulds\": " << r.s.shoulds << ", \"names\": " << r.s.names
+       << ", \"ok\": " << (r.ok ? "true" : "false") << std::fixed
+       << std::setprecision(1) << ", \"compile_time_ms\": " << r.wall_ms
+       << ", \"cpu_time_ms\": " << r.cpu_ms
+       << ", \"peak_rss_kb\": " << r.peak_rss_kb
+       << ", \"object_size_bytes\": " << r.object_size << "}"
+       << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+bool parse(int argc, char** argv, options& opt) {
+  for (auto i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    const auto value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "--cxx") {
+      opt.cxx = value;
+    } else if (key == "--flag") {
+      opt.flags.push_back(value);
+    } else if (key == "--out") {
+      opt.out = value;
+    } else if (key == "--work") {
+      opt.work = value;
+    } else if (key == "--filter") {
+      opt.filter = value;
+    } else if (key == "--repeat") {
+      opt.repeat = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--methods") {
+      opt.custom.methods = std::atoi(value.c_str());
+    } else if (key == "--args") {
+      opt.custom.args = std::atoi(value.c_str());
+    } else if (key == "--tests") {
+      opt.custom.tests = std::atoi(value.c_str());
+    } else if (key == "--shoulds") {
+      opt.custom.shoulds = std::atoi(value.c_str());
+    } else if (key == "--names") {
+      opt.custom.names = std::atoi(value.c_str());
+    } else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  options opt{};
+  if (!parse(argc, argv, opt)) {
+    return 1;
+  }
+
+  auto scenarios = default_scenarios();
+  if (opt.custom.methods || opt.custom.args || opt.custom.tests ||
+      opt.custom.shoulds || opt.custom.names) {
+    auto& c = opt.custom;
+    c.methods = std::max(1, c.methods ? c.methods : 10);
+    c.args = std::max(1, c.args ? c.args : 2);
+    c.tests = std::max(1, c.tests ? c.tests : 10);
+    c.shoulds = std::max(1, c.shoulds ? c.shoulds : 1);
+    scenarios = {c};
+  }
+
+  mkdir(opt.work.c_str(), 0755);
+
+  std::vector<result> results{};
+  const auto print = [](const result& r) {
+    std::cout << std::left << std::setw(24) << r.s.name << std::setw(10)
+              << r.variant << (r.ok ? "" : " FAILED") << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10)
+              << r.wall_ms << " ms" << std::setw(10) << r.peak_rss_kb
+              << " KB" << std::setw(12) << r.object_size << " B"
+              << std::endl;
+  };
+
+  if (!has_steps(opt)) {
+    std::cout << "note: json.hpp/gherkin.hpp not found, GSteps is skipped"
+              << std::endl;
+  }
+
+  results.push_back(precompile(opt));
+  print(results.back());
+
+  for (const auto& s : scenarios) {
+    if (s.name.find(opt.filter) == std::string::npos) {
+      continue;
+    }
+    for (const auto& variant : {"gunit", "gunit+pch", "gmock"}) {
+      results.push_back(run(opt, s, variant));
+      print(results.back());
+    }
+  }
+  std::ofstream out{opt.out};
+  report(out, opt, results);
+  std::cout << "report: " << opt.out << std::endl;
+
+  return std::all_of(results.begin(), results.end(),
+                     [](const auto& r) { return r.ok; })
+             ? 0
+             : 1;
+}
@@ -0,0 +1,352 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+/**
+ * Runtime benchmark
+ *
+ * Measures ns/op of expectation setup, matched/uninteresting invocations,
+ * fixture creation and teardown for testing::GMock<T> and hand written
+ * MOCK_METHOD mocks (benchmark/gtest/mocks), and of passed assertions for
+ * EXPECT (GUnit/GAssert.h) and EXPECT_EQ, and of EXPECT_RANGE_EQ.
+ *
+ * runtime [--out=report.json] [--filter=<substring>] [--samples=N]
+ *         [--budget_ms=N]
+ */
+#include <GUnit.h>
+#include <gtest/gtest-spi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "example.h"
+#include "gtest/mocks/mock_interface1.h"
+#include "gtest/mocks/mock_interface2.h"
+#include "gtest/mocks/mock_interface3.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct options {
+  std::string out{};
+  std::string filter{};
+  int samples{30};
+  double budget_ms{200};
+  double sample_ms{0.2};
+};
+
+struct stats {
+  std::string name{};
+  std::string variant{};
+  std::size_t ops{};
+  double mean{}, stddev{}, min{}, p50{}, p90{}, p99{}, max{};
+};
+
+template <class T>
+void do_not_optimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  const auto rank = p * (sorted.size() - 1);
+  const auto lo = static_cast<std::size_t>(rank);
+  const auto hi = std::min(lo + 1, sorted.size() - 1);
+  return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+/**
+ * @param op runs `n` operations, returns the time spent on the measured part
+ */
+stats measure(const options& opt, const std::string& name,
+              const std::string& variant,
+              const std::function<clock_type::duration(std::size_t)>& op) {
+  using ms = std::chrono::duration<double, std::milli>;
+  using ns = std::chrono::duration<double, std::nano>;
+
+  std::size_t n = 1;
+  while (ms{op(n)}.count() < opt.sample_ms && n < (1u << 24)) {
+    n *= 2;
+  }
+
+  std::vector<double> samples{};
+  auto total = 0.;
+  stats s{name, variant};
+  while (samples.size() < std::size_t(opt.samples) &&
+         (samples.empty() || total < opt.budget_ms)) {
+    const auto elapsed = op(n);
+    total += ms{elapsed}.count();
+    samples.push_back(ns{elapsed}.count() / n);
+    s.ops += n;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  for (const auto sample : samples) {
+    s.mean += sample / samples.size();
+  }
+  for (const auto sample : samples) {
+    s.stddev += (sample - s.mean) * (sample - s.mean) / samples.size();
+  }
+  s.stddev = std::sqrt(s.stddev);
+  s.min = samples.front();
+  s.p50 = percentile(samples, .50);
+  s.p90 = percentile(samples, .90);
+  s.p99 = percentile(samples, .99);
+  s.max = samples.back();
+  return s;
+}
+
+template <class F>
+auto timed(F&& f) {
+  const auto begin = clock_type::now();
+  f();
+  return clock_type::now() - begin;
+}
+
+struct gunit_fixture {
+  testing::mocks_t mocks;
+  std::unique_ptr<example> sut;  // has to be after mocks
+};
+
+struct gmock_fixture {
+  testing::NaggyMock<mock_interface1> m1;
+  testing::NaggyMock<mock_interface2> m2;
+  testing::NaggyMock<mock_interface3> m3;
+  std::unique_ptr<example> sut = std::make_unique<example>(m1, m2, m3);
+};
+
+template <class TMock, class TCall>
+auto uninteresting(TCall call) {
+  return [call](std::size_t n) {
+    TMock mock{};
+    testing::TestPartResultArray failures{};
+    testing::ScopedFakeTestPartResultReporter reporter{
+        testing::ScopedFakeTestPartResultReporter::INTERCEPT_ALL_THREADS,
+        &failures};
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        call(mock);
+      }
+    });
+  };
+}
+
+template <class TFixture, class TMake>
+auto fixtures(TMake make, bool teardown) {
+  return [make, teardown](std::size_t n) {
+    std::vector<std::unique_ptr<TFixture>> fixtures{};
+    fixtures.reserve(n);
+    const auto setup = timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        fixtures.push_back(make());
+      }
+    });
+    const auto tear_down = timed([&] { fixtures.clear(); });
+    return teardown ? tear_down : setup;
+  };
+}
+
+std::vector<stats> run(const options& opt) {
+  using namespace testing;
+
+  std::vector<stats> results{};
+  const auto bench = [&](const std::string& name, const std::string& variant,
+                         const auto& op) {
+    if ((name + "/" + variant).find(opt.filter) == std::string::npos) {
+      return;
+    }
+    results.push_back(measure(opt, name, variant, op));
+    const auto& s = results.back();
+    std::cout << std::left << std::setw(24) << name << std::setw(8) << variant
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << s.p50 << " ns/op (p90: " << s.p90
+              << ", p99: " << s.p99 << ", stddev: " << s.stddev << ")"
+              << std::endl;
+  };
+
+  bench("expect_call", "gunit", [](std::size_t n) {
+    GMock<interface1> mock{};
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        EXPECT_CALL(mock, (f1)(42)).Times(AnyNumber());
+      }
+    });
+  });
+  bench("expect_call", "gmock", [](std::size_t n) {
+    mock_interface1 mock{};
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        EXPECT_CALL(mock, f1(42)).Times(AnyNumber());
+      }
+    });
+  });
+
+  bench("matched_call", "gunit", [](std::size_t n) {
+    GMock<interface1> mock{};
+    EXPECT_CALL(mock, (f1)(42)).WillRepeatedly(Return(true));
+    const interface1& i1 = mock.object();
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        do_not_optimize(i1.f1(42));
+      }
+    });
+  });
+  bench("matched_call", "gmock", [](std::size_t n) {
+    mock_interface1 mock{};
+    EXPECT_CALL(mock, f1(42)).WillRepeatedly(Return(true));
+    const interface1& i1 = mock;
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        do_not_optimize(i1.f1(42));
+      }
+    });
+  });
+
+  const auto call = [](auto& mock) {
+    static_cast<interface2&>(mock).f2_1();
+  };
+  bench("uninteresting/naggy", "gunit",
+        uninteresting<NaggyGMock<interface2>>(call));
+  bench("uninteresting/naggy", "gmock",
+        uninteresting<NaggyMock<mock_interface2>>(call));
+  bench("uninteresting/nice", "gunit",
+        uninteresting<NiceGMock<interface2>>(call));
+  bench("uninteresting/nice", "gmock",
+        uninteresting<NiceMock<mock_interface2>>(call));
+  bench("uninteresting/strict", "gunit",
+        uninteresting<StrictGMock<interface2>>(call));
+  bench("uninteresting/strict", "gmock",
+        uninteresting<StrictMock<mock_interface2>>(call));
+
+  bench("expect/passed", "gunit", [](std::size_t n) {
+    auto value = 42;
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        do_not_optimize(value);
+        EXPECT(value == 42);
+      }
+    });
+  });
+  bench("expect/passed", "gtest", [](std::size_t n) {
+    auto value = 42;
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        do_not_optimize(value);
+        EXPECT_EQ(value, 42);
+      }
+    });
+  });
+  bench("expect/message", "gunit", [](std::size_t n) {
+    const std::string value{"a string which doesn't fit into the buffer"};
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        EXPECT(value == "a string which doesn't fit into the buffer")
+            << "message " << i;
+      }
+    });
+  });
+  bench("expect/message", "gtest", [](std::size_t n) {
+    const std::string value{"a string which doesn't fit into the buffer"};
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        EXPECT_EQ(value, "a string which doesn't fit into the buffer")
+            << "message " << i;
+      }
+    });
+  });
+  bench("expect/range_64k", "gunit", [](std::size_t n) {
+    const std::vector<std::uint8_t> actual(64 * 1024), expected(actual);
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        EXPECT_RANGE_EQ(actual, expected);
+      }
+    });
+  });
+  bench("expect/range_64k", "gtest", [](std::size_t n) {
+    const std::vector<std::uint8_t> actual(64 * 1024), expected(actual);
+    return timed([&] {
+      for (auto i = 0u; i < n; ++i) {
+        for (auto j = 0u; j < actual.size(); ++j) {
+          EXPECT_EQ(actual[j], expected[j]);
+        }
+      }
+    });
+  });
+
+  const auto make_gunit = [] {
+    auto fixture = std::make_unique<gunit_fixture>();
+    std::tie(fixture->sut, fixture->mocks) =
+        make<std::unique_ptr<example>, NaggyGMock>();
+    return fixture;
+  };
+  const auto make_gmock = [] { return std::make_unique<gmock_fixture>(); };
+  bench("make", "gunit", fixtures<gunit_fixture>(make_gunit, false));
+  bench("make", "gmock", fixtures<gmock_fixture>(make_gmock, false));
+  bench("teardown", "gunit", fixtures<gunit_fixture>(make_gunit, true));
+  bench("teardown", "gmock", fixtures<gmock_fixture>(make_gmock, true));
+
+  return results;
+}
+
+void report(std::ostream& os, const std::vector<stats>& results) {
+  os << "{\n  \"unit\": \"ns/op\",\n  \"results\": [\n" << std::fixed
+     << std::setprecision(2);
+  for (auto i = 0u; i < results.size(); ++i) {
+    const auto& s = results[i];
+    os << "    {\"name\": \"" << s.name << "\", \"variant\": \"" << s.variant
+       << "\", \"ops\": " << s.ops << ", \"mean\": " << s.mean
+       << ", \"stddev\": " << s.stddev << ", \"min\": " << s.min
+       << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90
+       << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}"
+       << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  testing::InitGoogleMock(&argc, argv);
+  testing::GMOCK_FLAG(verbose) = "error";  // no uninteresting call warnings
+
+  options opt{};
+  for (auto i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    const auto value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "--out") {
+      opt.out = value;
+    } else if (key == "--filter") {
+      opt.filter = value;
+    } else if (key == "--samples") {
+      opt.samples = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--budget_ms") {
+      opt.budget_ms = std::atof(value.c_str());
+    } else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return 1;
+    }
+  }
+
+  const auto results = run(opt);
+  if (!opt.out.empty()) {
+    std::ofstream out{opt.out};
+    report(out, results);
+  } else {
+    report(std::cout, results);
+  }
+}
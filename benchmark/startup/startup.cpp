@@ -0,0 +1,318 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+/**
+ * Startup benchmark
+ *
+ * Generates test binaries with N GUnit tests (GTEST) and N plain gtest tests
+ * (TEST), and times running a single one of them (`--gtest_filter`), listing
+ * them (`--gtest_list_tests`) and running all of them. Registration cost
+ * dominates the first two, which is what the report (JSON) is about.
+ *
+ * startup_benchmark --cxx=<compiler> [--flag=<flag>]... [--lib=<lib>]...
+ *                   [--out=report.json] [--work=<dir>] [--repeat=N]
+ *                   [--filter=<substring>] [--tests=N]
+ */
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto tests_per_file = 500;
+
+struct scenario {
+  std::string name{};
+  int tests{};
+};
+
+struct timing {
+  double wall_ms{};
+  long peak_rss_kb{};
+};
+
+struct result {
+  scenario s{};
+  std::string variant{};
+  bool ok{};
+  timing filter{};  // a single test selected by --gtest_filter
+  timing list{};    // --gtest_list_tests
+  timing all{};     // all tests
+};
+
+struct options {
+  std::string cxx{"c++"};
+  std::vector<std::string> flags{};
+  std::vector<std::string> libs{};
+  std::string out{"startup_benchmark.json"};
+  std::string work{"startup_benchmark"};
+  std::string filter{};
+  int repeat{5};
+  int tests{};
+};
+
+std::vector<scenario> default_scenarios() {
+  return {{"tests=100", 100}, {"tests=1000", 1000}, {"tests=2000", 2000}};
+}
+
+std::string gunit(int begin, int end) {
+  std::stringstream os{};
+  os << "#include <GUnit.h>\nstruct sut {};\n";
+  for (auto t = begin; t < end; ++t) {
+    os << "GTEST(sut, \"[test " << t << "]\") { EXPECT_EQ(" << t << ", "
+       << t << "); }\n";
+  }
+  return os.str();
+}
+
+std::string gtest(int begin, int end) {
+  std::stringstream os{};
+  os << "#include <gtest/gtest.h>\n";
+  for (auto t = begin; t < end; ++t) {
+    os << "TEST(sut, Test" << t << ") { EXPECT_EQ(" << t << ", " << t
+       << "); }\n";
+  }
+  return os.str();
+}
+
+/**
+ * @return exit status of the command, -1 if it couldn't be run
+ */
+int execute(std::vector<std::string> args, timing& t,
+            const std::string& output = "/dev/null") {
+  std::vector<char*> argv{};
+  for (auto& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  const auto begin = std::chrono::steady_clock::now();
+  const auto pid = fork();
+  if (pid == 0) {
+    const auto fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      dup2(fd, STDOUT_FILENO);
+      close(fd);
+    }
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  if (pid < 0) {
+    return -1;
+  }
+
+  int status{};
+  struct rusage usage {};
+  if (wait4(pid, &status, 0, &usage) < 0) {
+    return -1;
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  t.wall_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+#if defined(__APPLE__)
+  t.peak_rss_kb = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+  t.peak_rss_kb = usage.ru_maxrss;
+#endif
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @return the fastest of `repeat` runs
+ */
+bool measure(const options& opt, const std::vector<std::string>& args,
+             timing& best) {
+  for (auto i = 0; i < opt.repeat; ++i) {
+    timing t{};
+    if (execute(args, t)) {
+      return false;
+    }
+    if (!i || t.wall_ms < best.wall_ms) {
+      best = t;
+    }
+  }
+  return true;
+}
+
+bool build(const options& opt, const scenario& s, const std::string& variant,
+           const std::string& bin) {
+  std::vector<std::string> link{opt.cxx};
+  link.insert(link.end(), opt.flags.begin(), opt.flags.end());
+  for (auto begin = 0; begin < s.tests; begin += tests_per_file) {
+    const auto end = std::min(s.tests, begin + tests_per_file);
+    const auto file = bin + "_" + std::to_string(begin / tests_per_file);
+    std::ofstream{file + ".cpp"}
+        << (variant == "gunit" ? gunit(begin, end) : gtest(begin, end));
+
+    std::vector<std::string> args{opt.cxx};
+    args.insert(args.end(), opt.flags.begin(), opt.flags.end());
+    args.insert(args.end(), {"-c", file + ".cpp", "-o", file + ".o"});
+    timing t{};
+    if (execute(args, t)) {
+      return false;
+    }
+    link.push_back(file + ".o");
+  }
+  link.insert(link.end(), opt.libs.begin(), opt.libs.end());
+  link.insert(link.end(), {"-o", bin});
+  timing t{};
+  return !execute(link, t);
+}
+
+/**
+ * @return full name of the middle test listed by the binary
+ */
+std::string pick_test(const std::string& bin) {
+  timing t{};
+  const auto list = bin + ".list";
+  if (execute({bin, "--gtest_list_tests"}, t, list)) {
+    return {};
+  }
+  std::vector<std::string> names{};
+  std::ifstream in{list};
+  std::string suite{};
+  for (std::string line{}; std::getline(in, line);) {
+    const auto comment = line.find("  #");
+    line = line.substr(0, comment);
+    if (line.rfind("  ", 0) == 0) {
+      names.push_back(suite + line.substr(2));
+    } else if (!line.empty() && line.back() == '.') {
+      suite = line;
+    }
+  }
+  return names.empty() ? std::string{} : names[names.size() / 2];
+}
+
+result run(const options& opt, const scenario& s, const std::string& variant) {
+  auto file = s.name + "_" + variant;
+  for (auto& c : file) {
+    c = std::isalnum(c) ? c : '_';
+  }
+  const auto bin = opt.work + "/" + file;
+
+  result r{s, variant};
+  if (!build(opt, s, variant, bin)) {
+    return r;
+  }
+  const auto test = pick_test(bin);
+  r.ok = !test.empty() &&
+         measure(opt, {bin, "--gtest_filter=" + test}, r.filter) &&
+         measure(opt, {bin, "--gtest_list_tests"}, r.list) &&
+         measure(opt, {bin}, r.all);
+  return r;
+}
+
+void report(std::ostream& os, const options& opt,
+            const std::vector<result>& results) {
+  os << "{\n  \"compiler\": \"" << opt.cxx << "\",\n  \"flags\": [";
+  for (auto i = 0u; i < opt.flags.size(); ++i) {
+    os << (i ? ", " : "") << '"' << opt.flags[i] << '"';
+  }
+  os << "],\n  \"results\": [\n";
+  for (auto i = 0u; i < results.size(); ++i) {
+    const auto& r = results[i];
+    os << "    {\"scenario\": \"" << r.s.name << "\", \"variant\": \""
+       << r.variant << "\", \"tests\": " << r.s.tests
+       << ", \"ok\": " << (r.ok ? "true" : "false") << std::fixed
+       << std::setprecision(1) << ", \"filter_time_ms\": " << r.filter.wall_ms
+       << ", \"filter_peak_rss_kb\": " << r.filter.peak_rss_kb
+       << ", \"list_time_ms\": " << r.list.wall_ms
+       << ", \"all_time_ms\": " << r.all.wall_ms
+       << ", \"all_peak_rss_kb\": " << r.all.peak_rss_kb << "}"
+       << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+bool parse(int argc, char** argv, options& opt) {
+  for (auto i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+    const auto eq = arg.find('=');
+    const auto key = arg.substr(0, eq);
+    const auto value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "--cxx") {
+      opt.cxx = value;
+    } else if (key == "--flag") {
+      opt.flags.push_back(value);
+    } else if (key == "--lib") {
+      opt.libs.push_back(value);
+    } else if (key == "--out") {
+      opt.out = value;
+    } else if (key == "--work") {
+      opt.work = value;
+    } else if (key == "--filter") {
+      opt.filter = value;
+    } else if (key == "--repeat") {
+      opt.repeat = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--tests") {
+      opt.tests = std::atoi(value.c_str());
+    } else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  options opt{};
+  if (!parse(argc, argv, opt)) {
+    return 1;
+  }
+
+  auto scenarios = default_scenarios();
+  if (opt.tests > 0) {
+    scenarios = {{"custom", opt.tests}};
+  }
+
+  mkdir(opt.work.c_str(), 0755);
+
+  std::vector<result> results{};
+  const auto print = [](const result& r) {
+    std::cout << std::left << std::setw(14) << r.s.name << std::setw(8)
+              << r.variant << (r.ok ? "" : " FAILED") << std::right
+              << std::fixed << std::setprecision(1) << " filter"
+              << std::setw(9) << r.filter.wall_ms << " ms" << std::setw(9)
+              << r.filter.peak_rss_kb << " KB  list" << std::setw(9)
+              << r.list.wall_ms << " ms  all" << std::setw(9)
+              << r.all.wall_ms << " ms" << std::endl;
+  };
+
+  for (const auto& s : scenarios) {
+    if (s.name.find(opt.filter) == std::string::npos) {
+      continue;
+    }
+    for (const auto& variant : {"gunit", "gtest"}) {
+      results.push_back(run(opt, s, variant));
+      print(results.back());
+    }
+  }
+  std::ofstream out{opt.out};
+  report(out, opt, results);
+  std::cout << "report: " << opt.out << std::endl;
+
+  return std::all_of(results.begin(), results.end(),
+                     [](const auto& r) { return r.ok; })
+             ? 0
+             : 1;
+}
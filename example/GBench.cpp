@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "GUnit/GBench.h"
+#include <algorithm>
+#include <vector>
+#include "GUnit/GMock.h"
+
+struct interface {
+  virtual ~interface() = default;
+  virtual int get(int) const = 0;
+};
+
+class example {
+ public:
+  explicit example(const interface& i) : i(i) {}
+
+  int sum(int n) const {
+    auto result = 0;
+    for (auto x = 0; x < n; ++x) {
+      result += i.get(x);
+    }
+    return result;
+  }
+
+ private:
+  const interface& i;
+};
+
+GBENCH("Sort", "Sorted input", testing::Values(16, 1024)) {
+  std::vector<int> data(GetParam());
+  std::generate(data.begin(), data.end(), [n = 0]() mutable { return n++; });
+
+  MEASURE {
+    std::sort(data.begin(), data.end());
+    testing::DoNotOptimize(data);
+  }
+}
+
+GBENCH(example, "Sum with a mocked interface") {
+  using namespace testing;
+  EXPECT_CALL(mock<interface>(), (get)(_)).WillRepeatedly(Return(1));
+
+  MEASURE { DoNotOptimize(sut->sum(8)); }
+
+  EXPECT_EQ(8, sut->sum(8));
+}
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+/**
+ * C++20 module interface (`import gunit;`)
+ *
+ * Exports the non-macro API (GMock, make, object, GTest fixtures, matchers).
+ * Macros (GTEST, SHOULD, EXPECT, EXPECT_CALL, ...) can't be exported from a
+ * module, tests using them still have to include the headers (or the gunit_pch
+ * precompiled header).
+ */
+module;
+
+#include "GUnit.h"
+
+export module gunit;
+
+export namespace testing {
+using ::testing::v1::DoNotOptimize;
+using ::testing::v1::Generate;
+using ::testing::v1::GMock;
+using ::testing::v1::GTest;
+using ::testing::v1::Lines;
+using ::testing::v1::mocks_t;
+using ::testing::v1::NaggyGMock;
+using ::testing::v1::NiceGMock;
+using ::testing::v1::StrictGMock;
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::ByRef;
+using ::testing::InitGoogleMock;
+using ::testing::InitGoogleTest;
+using ::testing::make;
+using ::testing::NiceMock;
+using ::testing::object;
+using ::testing::Ref;
+using ::testing::Return;
+using ::testing::ReturnRef;
+using ::testing::StrictMock;
+using ::testing::Test;
+}  // namespace testing
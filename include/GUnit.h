@@ -8,6 +8,8 @@
 #pragma once
 
 #include "GUnit/GAssert.h"
+#include "GUnit/GBench.h"
+#include "GUnit/GFuzz.h"
 #include "GUnit/GMake.h"
 #include "GUnit/GMock.h"
 #include "GUnit/GTest-Lite.h"
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#if defined(__GNUC__)
+/**
+ * Allocation hooks of the current thread, defined by linking with
+ * `gunit_alloc` (which replaces the global operator new/delete)
+ */
+extern "C" std::uint64_t gunit_allocations() __attribute__((weak));
+extern "C" std::uint64_t gunit_allocated_bytes() __attribute__((weak));
+extern "C" void gunit_ignore_allocations(bool) __attribute__((weak));
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+inline bool has_allocations() {
+#if defined(__GNUC__)
+  return gunit_allocations != nullptr;
+#else
+  return false;
+#endif
+}
+
+inline std::uint64_t allocations() {
+#if defined(__GNUC__)
+  return gunit_allocations ? gunit_allocations() : 0;
+#else
+  return 0;
+#endif
+}
+
+inline std::uint64_t allocated_bytes() {
+#if defined(__GNUC__)
+  return gunit_allocated_bytes ? gunit_allocated_bytes() : 0;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Allocations made by the current thread in the scope are not counted
+ */
+class ignore_allocations {
+ public:
+  ignore_allocations() { ignore(true); }
+  ignore_allocations(const ignore_allocations&) = delete;
+  ignore_allocations& operator=(const ignore_allocations&) = delete;
+  ~ignore_allocations() { ignore(false); }
+
+ private:
+  static void ignore(bool value) {
+#if defined(__GNUC__)
+    if (gunit_ignore_allocations) {
+      gunit_ignore_allocations(value);
+    }
+#else
+    (void)value;
+#endif
+  }
+};
+
+/**
+ * Counts allocations of a block and reports a failure if there were more than
+ * `max`
+ *
+ * `for (allocations_at_most a{...}; a.next();) { block }`
+ */
+class allocations_at_most {
+ public:
+  allocations_at_most(
+      const char* file, int line, std::uint64_t max,
+      TestPartResult::Type failure = TestPartResult::kNonFatalFailure)
+      : file_{file}, line_{line}, max_{max}, failure_{failure} {}
+
+  /**
+   * @return true if the block has to be run
+   */
+  bool next() {
+    if (!started_) {
+      started_ = true;
+      bytes_ = allocated_bytes();
+      allocations_ = allocations();
+      return true;
+    }
+    const auto allocations = detail::allocations() - allocations_;
+    const auto bytes = allocated_bytes() - bytes_;
+    if (!has_allocations()) {
+      fail("Allocations are not tracked, link with `gunit_alloc`");
+    } else if (allocations > max_) {
+      fail("Expected at most " + std::to_string(max_) +
+           " allocation(s)\n  Actual: " + std::to_string(allocations) +
+           " allocation(s), " + std::to_string(bytes) + " bytes");
+    }
+    return false;
+  }
+
+ private:
+  void fail(const std::string& message) const {
+    internal::AssertHelper(failure_, file_, line_, message.c_str()) =
+        Message();
+  }
+
+  const char* file_{};
+  int line_{};
+  std::uint64_t max_{};
+  TestPartResult::Type failure_{};
+  bool started_{};
+  std::uint64_t allocations_{};
+  std::uint64_t bytes_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * GUnit flags are passed as `--gunit_<name>=<value>` (ignored by gtest) or
+ * as `GUNIT_<NAME>=<value>` environment variable
+ *
+ * @return flag value, "1" for `--gunit_<name>` without a value, empty if not
+ * set
+ */
+inline std::string flag(const std::string& name) {
+  const auto prefix = "--gunit_" + name;
+  for (const auto& arg : internal::GetArgvs()) {
+    if (arg == prefix) {
+      return "1";
+    }
+    if (arg.size() > prefix.size() && arg[prefix.size()] == '=' &&
+        !arg.compare(0, prefix.size(), prefix)) {
+      return arg.substr(prefix.size() + 1);
+    }
+  }
+
+  auto env = "GUNIT_" + name;
+  std::transform(env.begin(), env.end(), env.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+  const auto value = std::getenv(env.c_str());
+  return value ? value : "";
+}
+
+inline bool is_flag_enabled(const std::string& name) {
+  const auto value = flag(name);
+  return !value.empty() && value != "0" && value != "false" && value != "no";
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
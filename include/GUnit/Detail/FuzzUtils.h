@@ -0,0 +1,390 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__)
+/**
+ * Coverage of the code compiled with `-fsanitize-coverage=trace-pc-guard`
+ * (clang) or `-fsanitize-coverage=trace-pc` (gcc), defined by linking with
+ * `gunit_fuzz` (not instrumented itself)
+ *
+ * `gunit_coverage_stop` merges the hit counters since `gunit_coverage_start`
+ * into `seen` (`gunit_coverage_size` bytes) and returns the number of new
+ * features (edges x hit count buckets).
+ */
+extern "C" std::size_t gunit_coverage_size() __attribute__((weak));
+extern "C" void gunit_coverage_start() __attribute__((weak));
+extern "C" std::size_t gunit_coverage_stop(std::uint8_t* seen)
+    __attribute__((weak));
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+using bytes = std::vector<std::uint8_t>;
+
+inline std::uint64_t fnv1a(const bytes& data) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const auto byte : data) {
+    hash = (hash ^ byte) * 1099511628211ull;
+  }
+  return hash;
+}
+
+struct fuzz_options {
+  std::size_t runs = 10000;
+  std::chrono::milliseconds time{};  // 0 - no limit
+  std::size_t max_size = 1024;
+  std::size_t fixed_size{};  // 0 - inputs of any size up to `max_size`
+  std::uint64_t seed{};
+  std::string corpus{};  // directory, empty - in memory only
+  std::size_t minimize_runs = 4096;
+};
+
+struct fuzz_result {
+  std::size_t runs{};
+  std::size_t corpus{};
+  std::size_t features{};
+  bool failed{};
+  bytes input{};  // minimized failing input
+  std::size_t original_size{};
+};
+
+/**
+ * Coverage guided mutation fuzzer
+ *
+ * Mutates inputs of the corpus, inputs reaching new coverage (counters of
+ * the edges bucketed by hit count) are added to it. Without coverage
+ * (`gunit_fuzz` not linked or no instrumented code) inputs are mutated
+ * randomly. A failing input is minimized (chunks removed, bytes zeroed while
+ * it's still failing) and saved to the corpus, so that following runs start
+ * with it.
+ */
+class fuzzer {
+ public:
+  /**
+   * @param failed runs the tested code with the input, true if it failed
+   */
+  fuzzer(fuzz_options options, std::function<bool(const bytes&)> failed)
+      : options_{std::move(options)},
+        failed_{std::move(failed)},
+        random_{options_.seed} {
+    if (has_coverage()) {
+      seen_.resize(gunit_coverage_size());
+    }
+  }
+
+  static bool has_coverage() {
+#if defined(__GNUC__)
+    return gunit_coverage_size != nullptr;
+#else
+    return false;
+#endif
+  }
+
+  fuzz_result run() {
+    const crash_handler crash{options_.corpus};
+    load();
+    if (corpus_.empty()) {
+      corpus_.push_back(bytes(options_.fixed_size));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto expired = [&] {
+      return options_.time.count() &&
+             std::chrono::steady_clock::now() - start >= options_.time;
+    };
+
+    for (auto i = 0u; i < corpus_.size(); ++i) {  // seeds
+      const auto input = corpus_[i];
+      if (execute(input)) {
+        return failure(input);
+      }
+    }
+    for (auto input = bytes{}; result_.runs < options_.runs;) {
+      if (!(result_.runs % 256) && expired()) {
+        break;
+      }
+      input = corpus_[random_() % corpus_.size()];
+      mutate(input);
+      if (execute(input)) {
+        return failure(input);
+      }
+      if (new_coverage_) {
+        corpus_.push_back(input);
+        save(input);
+      }
+    }
+    result_.corpus = corpus_.size();
+    return result_;
+  }
+
+ private:
+  /**
+   * Writes the input being run to `<corpus>/crash` on a fatal signal
+   */
+  class crash_handler {
+   public:
+    explicit crash_handler(const std::string& corpus) {
+#if defined(__unix__) || defined(__APPLE__)
+      if (corpus.empty() || instance()) {
+        return;
+      }
+      std::error_code ec{};
+      std::filesystem::create_directories(corpus, ec);
+      path_ = corpus + "/crash";
+      instance() = this;
+      for (const auto signal : signals) {
+        previous_.push_back(std::signal(signal, &handle));
+      }
+#else
+      (void)corpus;
+#endif
+    }
+    crash_handler(const crash_handler&) = delete;
+    crash_handler& operator=(const crash_handler&) = delete;
+
+    ~crash_handler() {
+#if defined(__unix__) || defined(__APPLE__)
+      if (instance() == this) {
+        for (auto i = 0u; i < previous_.size(); ++i) {
+          std::signal(signals[i], previous_[i]);
+        }
+        instance() = nullptr;
+      }
+#endif
+    }
+
+    static void current(const bytes* input) {
+      if (instance()) {
+        instance()->input_ = input;
+      }
+    }
+
+   private:
+    static constexpr int signals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#if defined(SIGBUS)
+                                      SIGBUS
+#endif
+    };
+
+    static crash_handler*& instance() {
+      static crash_handler* handler{};
+      return handler;
+    }
+
+    static void handle(int signal) {
+#if defined(__unix__) || defined(__APPLE__)
+      const auto* self = instance();
+      if (self && self->input_) {
+        const auto fd =
+            ::open(self->path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+          (void)!::write(fd, self->input_->data(), self->input_->size());
+          ::close(fd);
+        }
+      }
+#endif
+      std::signal(signal, SIG_DFL);
+      std::raise(signal);
+    }
+
+    std::string path_{};
+    const bytes* input_{};
+    std::vector<void (*)(int)> previous_{};
+  };
+
+  bool execute(const bytes& input) {
+    ++result_.runs;
+    crash_handler::current(&input);
+    const auto coverage = !seen_.empty();
+#if defined(__GNUC__)
+    if (coverage) {
+      gunit_coverage_start();
+    }
+#endif
+    const auto failed = failed_(input);
+    std::size_t features{};
+#if defined(__GNUC__)
+    if (coverage) {
+      features = gunit_coverage_stop(seen_.data());
+    }
+#endif
+    crash_handler::current(nullptr);
+    result_.features += features;
+    new_coverage_ = features != 0;
+    return failed;
+  }
+
+  void mutate(bytes& input) {
+    static constexpr std::uint8_t interesting[] = {0,    1,   0x7f, 0x80,
+                                                   0xff, '0', 'a',  ' '};
+    const auto fixed = options_.fixed_size != 0;
+    for (auto n = 1 + random_() % 4; n--;) {
+      const auto pos = input.empty() ? 0 : random_() % input.size();
+      switch (random_() % (fixed ? 4 : 7)) {
+        case 0:
+          if (!input.empty()) {
+            input[pos] ^= std::uint8_t(1u << random_() % 8);
+          }
+          break;
+        case 1:
+          if (!input.empty()) {
+            input[pos] = std::uint8_t(random_());
+          }
+          break;
+        case 2:
+          if (!input.empty()) {
+            input[pos] = interesting[random_() % std::size(interesting)];
+          }
+          break;
+        case 3: {  // copy from another input
+          const auto& other = corpus_[random_() % corpus_.size()];
+          if (!other.empty() && !input.empty()) {
+            const auto from = random_() % other.size();
+            const auto size = std::min(
+                {std::size_t(1 + random_() % 8), other.size() - from,
+                 input.size() - pos});
+            std::copy_n(other.begin() + from, size, input.begin() + pos);
+          }
+        } break;
+        case 4:
+          if (input.size() < options_.max_size) {
+            input.insert(input.begin() + random_() % (input.size() + 1),
+                         std::uint8_t(random_()));
+          }
+          break;
+        case 5:
+          if (!input.empty()) {
+            input.erase(input.begin() + pos);
+          }
+          break;
+        case 6:  // duplicate a chunk
+          if (!input.empty() && input.size() < options_.max_size) {
+            const auto size = std::min(
+                {std::size_t(1 + random_() % 8), input.size() - pos,
+                 options_.max_size - input.size()});
+            const bytes chunk(input.begin() + pos, input.begin() + pos + size);
+            input.insert(input.begin() + pos, chunk.begin(), chunk.end());
+          }
+          break;
+      }
+    }
+  }
+
+  bytes minimize(bytes input) {
+    auto budget = options_.minimize_runs;
+    const auto still_fails = [&](const bytes& candidate) {
+      return budget && (--budget, ++result_.runs, failed_(candidate));
+    };
+    if (!options_.fixed_size) {
+      for (auto chunk = input.size() / 2; chunk; chunk /= 2) {
+        for (auto pos = 0u; pos + chunk <= input.size();) {
+          auto candidate = input;
+          candidate.erase(candidate.begin() + pos,
+                          candidate.begin() + pos + chunk);
+          if (still_fails(candidate)) {
+            input = std::move(candidate);
+          } else {
+            pos += chunk;
+          }
+        }
+      }
+    }
+    for (auto& byte : input) {
+      if (byte) {
+        const auto original = byte;
+        byte = 0;
+        if (!still_fails(input)) {
+          byte = original;
+        }
+      }
+    }
+    return input;
+  }
+
+  fuzz_result failure(const bytes& input) {
+    result_.failed = true;
+    result_.original_size = input.size();
+    result_.input = minimize(input);
+    result_.corpus = corpus_.size();
+    save(result_.input);
+    return result_;
+  }
+
+  void load() {
+    if (options_.corpus.empty()) {
+      return;
+    }
+    std::error_code ec{};
+    std::vector<std::filesystem::path> files{};
+    for (const auto& entry :
+         std::filesystem::directory_iterator{options_.corpus, ec}) {
+      if (entry.is_regular_file(ec) && entry.path().filename() != "crash") {
+        files.push_back(entry.path());
+      }
+    }
+    std::sort(files.begin(), files.end());  // deterministic order
+    for (const auto& file : files) {
+      std::ifstream in{file, std::ios::binary};
+      bytes input{std::istreambuf_iterator<char>{in},
+                  std::istreambuf_iterator<char>{}};
+      if (options_.fixed_size) {
+        input.resize(options_.fixed_size);
+      } else if (input.size() > options_.max_size) {
+        input.resize(options_.max_size);
+      }
+      corpus_.push_back(std::move(input));
+    }
+  }
+
+  void save(const bytes& input) const {
+    if (options_.corpus.empty()) {
+      return;
+    }
+    std::error_code ec{};
+    std::filesystem::create_directories(options_.corpus, ec);
+    char name[17]{};
+    std::snprintf(name, sizeof(name), "%016llx",
+                  static_cast<unsigned long long>(fnv1a(input)));
+    std::ofstream{options_.corpus + "/" + name, std::ios::binary}.write(
+        reinterpret_cast<const char*>(input.data()),
+        std::streamsize(input.size()));
+  }
+
+  fuzz_options options_{};
+  std::function<bool(const bytes&)> failed_{};
+  std::mt19937_64 random_{};
+  std::vector<bytes> corpus_{};
+  std::vector<std::uint8_t> seen_{};
+  bool new_coverage_{};
+  fuzz_result result_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
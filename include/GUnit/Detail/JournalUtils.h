@@ -0,0 +1,615 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+enum class journal_kind : std::uint8_t { START, FAILURE, TEST, SECTION, STEP };
+enum class journal_status : std::uint8_t { PASSED, FAILED, SKIPPED };
+
+/**
+ * Append-only journal of the results, memory-mapped from a file
+ *
+ * Records are written as soon as tests start, fail and finish (and SHOULD
+ * sections/steps finish) straight into the page cache, so they survive a
+ * crash of the test binary. Processes forked once it's open (`--gunit_jobs`
+ * workers, `--gunit_fork` children) append to the same mapping.
+ *
+ * Layout: [magic:8][used:u64][dropped:u64] followed by 8 bytes aligned
+ * records [size:u32][committed:u32][kind:u8][status:u8][:u16][test size:u32]
+ * [detail size:u32][:u32][us:u64][test][detail]. Space is reserved with an
+ * atomic add and a record is valid once it's committed. The file is mapped
+ * with a fixed (sparse) capacity and truncated to the used size on exit.
+ */
+class result_journal {
+ public:
+  static constexpr char magic[8] = {'G', 'U', 'N', 'I', 'T', 'J', '1', '\n'};
+  static constexpr std::size_t default_capacity = 64u << 20;
+
+  struct header {
+    char magic[8];
+    std::atomic<std::uint64_t> used;
+    std::atomic<std::uint64_t> dropped;
+  };
+
+  struct record {
+    std::uint32_t size;
+    std::atomic<std::uint32_t> committed;
+    journal_kind kind;
+    journal_status status;
+    std::uint16_t reserved;
+    std::uint32_t test_size;
+    std::uint32_t detail_size;
+    std::uint32_t reserved2;
+    std::uint64_t us;
+  };
+  static_assert(sizeof(record) == 32, "record has to be 8 bytes aligned");
+
+  explicit result_journal(const std::string& file,
+                          std::size_t capacity = default_capacity) {
+#if GUNIT_HAS_FORK
+    if (file.empty()) {
+      return;
+    }
+    const auto fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cerr << "Can't open the journal \"" << file << "\"" << std::endl;
+      return;
+    }
+    const auto size = sizeof(header) + capacity;
+    void* data = MAP_FAILED;
+    if (!::ftruncate(fd, off_t(size))) {
+      data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      std::cerr << "Can't map the journal \"" << file << "\"" << std::endl;
+      return;
+    }
+    fd_ = fd;
+    pid_ = ::getpid();
+    size_ = size;
+    data_ = static_cast<char*>(data);
+    header_ = new (data_) header{{}, {}, {}};
+    std::memcpy(header_->magic, magic, sizeof(magic));
+#else
+    (void)file;
+    (void)capacity;
+#endif
+  }
+
+  result_journal(const result_journal&) = delete;
+  result_journal& operator=(const result_journal&) = delete;
+
+  ~result_journal() {
+#if GUNIT_HAS_FORK
+    if (!header_) {
+      return;
+    }
+    const auto used = std::min<std::uint64_t>(header_->used,
+                                               size_ - sizeof(header));
+    ::munmap(data_, size_);
+    if (pid_ == ::getpid()) {  // not by forked children
+      (void)::ftruncate(fd_, off_t(sizeof(header) + used));
+    }
+    ::close(fd_);
+#endif
+  }
+
+  bool is_enabled() const { return header_; }
+
+  void append(journal_kind kind, journal_status status, std::uint64_t us,
+              std::string_view test, std::string_view detail = {}) {
+    if (!header_) {
+      return;
+    }
+    const auto size =
+        (sizeof(record) + test.size() + detail.size() + 7) & ~std::size_t(7);
+    const auto offset = header_->used.fetch_add(size);
+    if (offset + size > size_ - sizeof(header)) {
+      ++header_->dropped;
+      return;
+    }
+    auto ptr = data_ + sizeof(header) + offset;
+    const auto r = new (ptr) record{std::uint32_t(size), {}, kind, status, {},
+                                    std::uint32_t(test.size()),
+                                    std::uint32_t(detail.size()), {}, us};
+    std::memcpy(ptr + sizeof(record), test.data(), test.size());
+    std::memcpy(ptr + sizeof(record) + test.size(), detail.data(),
+                detail.size());
+    r->committed.store(1, std::memory_order_release);
+  }
+
+ private:
+  int fd_ = -1;
+  int pid_{};
+  std::size_t size_{};
+  char* data_{};
+  header* header_{};
+};
+
+/**
+ * Read-only view of a journal, records aren't copied
+ */
+class journal_reader {
+ public:
+  struct entry {
+    std::uint64_t offset{};
+    journal_kind kind{};
+    journal_status status{};
+    std::uint64_t us{};
+    std::string_view test{};
+    std::string_view detail{};
+  };
+
+  explicit journal_reader(const std::string& file) {
+#if GUNIT_HAS_FORK
+    const auto fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st {};
+    if (!::fstat(fd, &st) &&
+        std::size_t(st.st_size) >= sizeof(result_journal::header)) {
+      const auto data = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ,
+                               MAP_SHARED, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char*>(data);
+        size_ = std::size_t(st.st_size);
+      }
+    }
+    ::close(fd);
+    if (data_ && std::memcmp(data_, result_journal::magic,
+                             sizeof(result_journal::magic))) {
+      ::munmap(const_cast<char*>(data_), size_);
+      data_ = nullptr;
+    }
+#else
+    (void)file;
+#endif
+  }
+
+  journal_reader(journal_reader&& other) noexcept
+      : data_{other.data_}, size_{other.size_} {
+    other.data_ = nullptr;
+  }
+  journal_reader(const journal_reader&) = delete;
+  journal_reader& operator=(const journal_reader&) = delete;
+
+  ~journal_reader() {
+#if GUNIT_HAS_FORK
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+  }
+
+  bool is_open() const { return data_; }
+
+  std::uint64_t dropped() const { return data_ ? header()->dropped.load() : 0; }
+
+  /**
+   * Calls `f(entry)` for every committed record, in the order of their
+   * reservation
+   */
+  template <class F>
+  void for_each(const F& f) const {
+    if (!data_) {
+      return;
+    }
+    const auto end = std::min<std::uint64_t>(
+        header()->used, size_ - sizeof(result_journal::header));
+    entry e{};
+    for (std::uint64_t offset{};
+         offset + sizeof(result_journal::record) <= end;) {
+      bool committed{};
+      const auto size = read(offset, e, committed);
+      if (!size) {
+        break;  // reserved, but not written yet (crash)
+      }
+      if (committed) {
+        f(e);
+      }
+      offset += size;
+    }
+  }
+
+  entry at(std::uint64_t offset) const {
+    entry e{};
+    bool committed{};
+    (void)read(offset, e, committed);
+    return e;
+  }
+
+ private:
+  const result_journal::header* header() const {
+    return reinterpret_cast<const result_journal::header*>(data_);
+  }
+
+  /**
+   * @return size of the record at `offset`, 0 if it's invalid
+   */
+  std::uint32_t read(std::uint64_t offset, entry& e, bool& committed) const {
+    const auto ptr = data_ + sizeof(result_journal::header) + offset;
+    const auto r = reinterpret_cast<const result_journal::record*>(ptr);
+    if (r->size < sizeof(result_journal::record) ||
+        offset + r->size > size_ - sizeof(result_journal::header) ||
+        sizeof(result_journal::record) + std::uint64_t(r->test_size) +
+                r->detail_size >
+            r->size) {
+      return 0;
+    }
+    committed = r->committed.load(std::memory_order_acquire);
+    if (committed) {
+      const auto text = ptr + sizeof(result_journal::record);
+      e = entry{offset, r->kind, r->status, r->us, {text, r->test_size},
+                {text + r->test_size, r->detail_size}};
+    }
+    return r->size;
+  }
+
+  const char* data_{};
+  std::size_t size_{};
+};
+
+/**
+ * Converts journals (e.g. of several shards) to JUnit XML or gtest JSON
+ * reports
+ *
+ * Tests are grouped by suite, in the order they have been started, with
+ * their failures, SHOULD sections and steps. A test which has been started
+ * but has no result (the binary crashed or has been killed) is reported as
+ * failed. Only offsets of the records are kept in memory.
+ */
+class journal_report {
+  struct test {
+    std::size_t journal{};
+    std::string_view name{};
+    bool ended{};
+    std::uint64_t end{};
+    std::vector<std::uint64_t> parts{};  // failures, sections, steps
+  };
+
+  struct suite {
+    std::string_view name{};
+    std::vector<test> tests{};
+    std::size_t failures{};
+    std::size_t skipped{};
+    std::uint64_t us{};
+  };
+
+ public:
+  explicit journal_report(const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+      journals_.emplace_back(file);
+      if (!journals_.back().is_open()) {
+        std::cerr << "Can't read the journal \"" << file << "\"" << std::endl;
+      }
+    }
+    for (auto j = 0u; j < journals_.size(); ++j) {
+      std::unordered_map<std::string_view, std::pair<std::size_t, std::size_t>>
+          current{};  // test -> suite, test index
+      const auto find = [&](std::string_view name, bool start) -> test& {
+        const auto it = current.find(name);
+        if (it != current.end()) {
+          auto& t = suites_[it->second.first].tests[it->second.second];
+          if (!(start && t.ended)) {
+            return t;
+          }
+        }
+        const auto s = suite_index(name.substr(0, name.find('.')));
+        suites_[s].tests.push_back(test{j, name});
+        current[name] = {s, suites_[s].tests.size() - 1};
+        return suites_[s].tests.back();
+      };
+      journals_[j].for_each([&](const journal_reader::entry& e) {
+        switch (e.kind) {
+          case journal_kind::START:
+            find(e.test, true);
+            break;
+          case journal_kind::TEST: {
+            auto& t = find(e.test, false);
+            t.ended = true;
+            t.end = e.offset;
+          } break;
+          default:
+            find(e.test, false).parts.push_back(e.offset);
+            break;
+        }
+      });
+      dropped_ += journals_[j].dropped();
+    }
+
+    for (auto& s : suites_) {
+      for (const auto& t : s.tests) {
+        const auto e = end(t);
+        s.failures += e.status == journal_status::FAILED;
+        s.skipped += e.status == journal_status::SKIPPED;
+        s.us += e.us;
+      }
+    }
+  }
+
+  /**
+   * @return number of records which didn't fit into the journals
+   */
+  std::uint64_t dropped() const { return dropped_; }
+
+  void write_xml(std::ostream& os) const {
+    std::size_t tests{}, failures{};
+    std::uint64_t us{};
+    for (const auto& s : suites_) {
+      tests += s.tests.size();
+      failures += s.failures;
+      us += s.us;
+    }
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<testsuites tests=\"" << tests << "\" failures=\"" << failures
+       << "\" disabled=\"0\" errors=\"0\" time=\"" << seconds(us)
+       << "\" name=\"AllTests\">\n";
+    for (const auto& s : suites_) {
+      os << "  <testsuite name=\"" << xml(s.name) << "\" tests=\""
+         << s.tests.size() << "\" failures=\"" << s.failures
+         << "\" disabled=\"0\" skipped=\"" << s.skipped
+         << "\" errors=\"0\" time=\"" << seconds(s.us) << "\">\n";
+      for (const auto& t : s.tests) {
+        const auto e = end(t);
+        os << "    <testcase name=\"" << xml(test_name(t.name))
+           << "\" status=\"run\" result=\""
+           << (e.status == journal_status::SKIPPED ? "skipped" : "completed")
+           << "\" time=\"" << seconds(e.us) << "\" classname=\""
+           << xml(s.name) << "\"";
+        if (t.parts.empty() && t.ended &&
+            e.status != journal_status::SKIPPED) {
+          os << " />\n";
+          continue;
+        }
+        os << ">\n";
+        std::string properties{};
+        for (const auto offset : t.parts) {
+          const auto p = journals_[t.journal].at(offset);
+          if (p.kind == journal_kind::FAILURE) {
+            os << "      <failure message=\"" << xml(p.detail)
+               << "\" type=\"\"><![CDATA[" << cdata(p.detail)
+               << "]]></failure>\n";
+          } else {
+            properties += "        <property name=\"" + xml(p.detail) +
+                          "\" value=\"" + status(p.status) + ' ' +
+                          seconds(p.us) + "s\"/>\n";
+          }
+        }
+        if (!t.ended) {
+          os << "      <failure message=\"" << xml(crashed)
+             << "\" type=\"\"><![CDATA[" << crashed << "]]></failure>\n";
+        }
+        if (e.status == journal_status::SKIPPED) {
+          os << "      <skipped message=\"\" />\n";
+        }
+        if (!properties.empty()) {
+          os << "      <properties>\n"
+             << properties << "      </properties>\n";
+        }
+        os << "    </testcase>\n";
+      }
+      os << "  </testsuite>\n";
+    }
+    os << "</testsuites>\n";
+  }
+
+  void write_json(std::ostream& os) const {
+    std::size_t tests{}, failures{};
+    std::uint64_t us{};
+    for (const auto& s : suites_) {
+      tests += s.tests.size();
+      failures += s.failures;
+      us += s.us;
+    }
+    os << "{\n  \"tests\": " << tests << ",\n  \"failures\": " << failures
+       << ",\n  \"disabled\": 0,\n  \"errors\": 0,\n  \"time\": \""
+       << seconds(us) << "s\",\n  \"name\": \"AllTests\",\n"
+       << "  \"testsuites\": [";
+    for (auto i = 0u; i < suites_.size(); ++i) {
+      const auto& s = suites_[i];
+      os << (i ? "," : "") << "\n    {\n      \"name\": " << json(s.name)
+         << ",\n      \"tests\": " << s.tests.size()
+         << ",\n      \"failures\": " << s.failures
+         << ",\n      \"disabled\": 0,\n      \"errors\": 0,"
+         << "\n      \"time\": \""
+         << seconds(s.us) << "s\",\n      \"testsuite\": [";
+      for (auto n = 0u; n < s.tests.size(); ++n) {
+        const auto& t = s.tests[n];
+        const auto e = end(t);
+        os << (n ? "," : "") << "\n        {\n          \"name\": "
+           << json(test_name(t.name)) << ",\n          \"status\": \"RUN\""
+           << ",\n          \"result\": \""
+           << (e.status == journal_status::SKIPPED ? "SKIPPED" : "COMPLETED")
+           << "\",\n          \"time\": \"" << seconds(e.us)
+           << "s\",\n          \"classname\": " << json(s.name);
+        std::string failures_json{}, sections_json{};
+        for (const auto offset : t.parts) {
+          const auto p = journals_[t.journal].at(offset);
+          if (p.kind == journal_kind::FAILURE) {
+            failures_json += (failures_json.empty() ? "" : ",") +
+                             std::string{"\n            {\n              "
+                                         "\"failure\": "} +
+                             json(p.detail) +
+                             ",\n              \"type\": \"\"\n            }";
+          } else {
+            sections_json +=
+                (sections_json.empty() ? "" : ",") +
+                std::string{"\n            {\n              \"name\": "} +
+                json(p.detail) + ",\n              \"type\": \"" +
+                (p.kind == journal_kind::STEP ? "STEP" : "SHOULD") +
+                "\",\n              \"status\": \"" + status(p.status) +
+                "\",\n              \"time\": \"" + seconds(p.us) +
+                "s\"\n            }";
+          }
+        }
+        if (!t.ended) {
+          failures_json += (failures_json.empty() ? "" : ",") +
+                           std::string{"\n            {\n              "
+                                       "\"failure\": "} +
+                           json(crashed) +
+                           ",\n              \"type\": \"\"\n            }";
+        }
+        if (!failures_json.empty()) {
+          os << ",\n          \"failures\": [" << failures_json
+             << "\n          ]";
+        }
+        if (!sections_json.empty()) {
+          os << ",\n          \"sections\": [" << sections_json
+             << "\n          ]";
+        }
+        os << "\n        }";
+      }
+      os << "\n      ]\n    }";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+ private:
+  static constexpr auto crashed =
+      "No result in the journal, the test binary crashed or has been killed";
+
+  std::size_t suite_index(std::string_view name) {
+    const auto it = index_.find(name);
+    if (it != index_.end()) {
+      return it->second;
+    }
+    suites_.push_back(suite{name});
+    return index_[name] = suites_.size() - 1;
+  }
+
+  journal_reader::entry end(const test& t) const {
+    if (t.ended) {
+      return journals_[t.journal].at(t.end);
+    }
+    journal_reader::entry e{};
+    e.status = journal_status::FAILED;
+    return e;
+  }
+
+  static std::string_view test_name(std::string_view name) {
+    const auto dot = name.find('.');
+    return dot == std::string_view::npos ? name : name.substr(dot + 1);
+  }
+
+  static std::string status(journal_status s) {
+    return s == journal_status::FAILED    ? "failed"
+           : s == journal_status::SKIPPED ? "skipped"
+                                          : "passed";
+  }
+
+  static std::string seconds(std::uint64_t us) {
+    std::ostringstream str{};
+    str << std::fixed << std::setprecision(3) << double(us) / 1e6;
+    return str.str();
+  }
+
+  static std::string xml(std::string_view str) {
+    std::string result{};
+    for (const auto c : str) {
+      switch (c) {
+        case '<': result += "&lt;"; break;
+        case '>': result += "&gt;"; break;
+        case '&': result += "&amp;"; break;
+        case '"': result += "&quot;"; break;
+        case '\'': result += "&apos;"; break;
+        case '\n': result += "&#x0A;"; break;
+        default:
+          if (static_cast<unsigned char>(c) >= 0x20 || c == '\t') {
+            result += c;
+          }
+      }
+    }
+    return result;
+  }
+
+  static std::string cdata(std::string_view str) {
+    std::string result{};
+    for (std::size_t pos{};;) {
+      const auto end = str.find("]]>", pos);
+      if (end == std::string_view::npos) {
+        result += str.substr(pos);
+        return result;
+      }
+      result += str.substr(pos, end - pos);
+      result += "]]>]]&gt;<![CDATA[";
+      pos = end + 3;
+    }
+  }
+
+  static std::string json(std::string_view str) {
+    std::string result{"\""};
+    for (const auto c : str) {
+      switch (c) {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+          } else {
+            result += c;
+          }
+      }
+    }
+    return result + '"';
+  }
+
+  std::vector<journal_reader> journals_{};
+  std::vector<suite> suites_{};
+  std::unordered_map<std::string_view, std::size_t> index_{};
+  std::uint64_t dropped_{};
+};
+
+/**
+ * `--gunit_journal=<file>` (GUNIT_JOURNAL=<file>) journals the results of the
+ * run (disabled by default), see `result_journal`
+ */
+inline result_journal& journal() {
+  static result_journal j{flag("journal")};
+  return j;
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
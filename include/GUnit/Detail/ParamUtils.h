@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * Input range of the values returned by `next` until it returns an empty
+ * optional, nothing is computed before it's iterated
+ */
+template <class TNext>
+class generator {
+ public:
+  using value_type =
+      typename std::decay_t<decltype(std::declval<TNext&>()())>::value_type;
+
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = generator::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    explicit iterator(generator* g = nullptr) : g_{g} {}
+
+    reference operator*() const { return *g_->value_; }
+    iterator& operator++() {
+      g_->value_ = g_->next_();
+      return *this;
+    }
+    bool operator!=(const iterator&) const { return g_ && g_->value_; }
+    bool operator==(const iterator& other) const { return !(*this != other); }
+
+   private:
+    generator* g_{};
+  };
+
+  explicit generator(TNext next) : next_{std::move(next)} {}
+
+  iterator begin() {
+    value_ = next_();
+    return iterator{this};
+  }
+  iterator end() { return iterator{}; }
+
+ private:
+  TNext next_;
+  std::optional<value_type> value_{};
+};
+
+/**
+ * Input range of the lines of a file, read one at a time
+ */
+class lines {
+ public:
+  using value_type = std::string;
+
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string*;
+    using reference = const std::string&;
+
+    explicit iterator(lines* l = nullptr) : l_{l} {}
+
+    reference operator*() const { return l_->line_; }
+    iterator& operator++() {
+      l_->read();
+      return *this;
+    }
+    bool operator!=(const iterator&) const { return l_ && l_->good_; }
+    bool operator==(const iterator& other) const { return !(*this != other); }
+
+   private:
+    lines* l_{};
+  };
+
+  explicit lines(std::string file) : file_{std::move(file)} {}
+
+  iterator begin() {
+    in_ = std::make_unique<std::ifstream>(file_);
+    if (!*in_) {
+      throw std::runtime_error{"Can't open \"" + file_ + "\""};
+    }
+    read();
+    return iterator{this};
+  }
+  iterator end() { return iterator{}; }
+
+ private:
+  void read() { good_ = bool(std::getline(*in_, line_)); }
+
+  std::string file_{};
+  std::unique_ptr<std::ifstream> in_{};
+  std::string line_{};
+  bool good_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
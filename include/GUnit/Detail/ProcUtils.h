@@ -0,0 +1,435 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+// Feature detection: fork/pipe support
+#if !defined(GUNIT_HAS_FORK)
+  #if (defined(__APPLE__) || defined(__linux__)) && !defined(__ZEPHYR__)
+    #define GUNIT_HAS_FORK 1
+  #else
+    #define GUNIT_HAS_FORK 0
+  #endif
+#endif
+
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if GUNIT_HAS_FORK
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+#if GUNIT_HAS_FORK
+inline bool write_all(int fd, const void* data, std::size_t size) {
+  auto ptr = static_cast<const char*>(data);
+  while (size) {
+    const auto n = ::write(fd, ptr, size);
+    if (n <= 0) {
+      return false;
+    }
+    ptr += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+inline bool read_all(int fd, void* data, std::size_t size) {
+  auto ptr = static_cast<char*>(data);
+  while (size) {
+    const auto n = ::read(fd, ptr, size);
+    if (n <= 0) {
+      return false;
+    }
+    ptr += n;
+    size -= std::size_t(n);
+  }
+  return true;
+}
+
+/**
+ * Test part result wire format
+ * [type:i32][line:i32][file size:i32, -1 if none][file][message size:i32]
+ * [message]
+ */
+inline std::string serialize(const TestPartResult& result) {
+  std::string data{};
+  const auto append = [&data](std::int32_t value) {
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  const auto file = result.file_name();
+  append(result.type());
+  append(result.line_number());
+  append(file ? std::int32_t(std::string{file}.size()) : -1);
+  data += file ? file : "";
+  append(std::int32_t(std::string{result.message()}.size()));
+  data += result.message();
+  return data;
+}
+
+/**
+ * Parses the wire format, `read(void* data, std::size_t size)` reads the next
+ * `size` bytes (false if there aren't so many)
+ */
+template <class TRead>
+std::unique_ptr<TestPartResult> parse_result(TRead read) {
+  std::int32_t type{}, line{}, file_size{}, message_size{};
+  if (!read(&type, sizeof(type)) || !read(&line, sizeof(line)) ||
+      !read(&file_size, sizeof(file_size))) {
+    return {};
+  }
+  std::string file(file_size > 0 ? std::size_t(file_size) : 0, '\0');
+  if (!read(&file[0], file.size()) ||
+      !read(&message_size, sizeof(message_size)) || message_size < 0) {
+    return {};
+  }
+  std::string message(std::size_t(message_size), '\0');
+  if (!read(&message[0], message.size())) {
+    return {};
+  }
+  return std::make_unique<TestPartResult>(
+      TestPartResult::Type(type), file_size < 0 ? nullptr : file.c_str(),
+      line, message.c_str());
+}
+
+inline std::unique_ptr<TestPartResult> deserialize(const std::string& data) {
+  std::size_t pos{};
+  return parse_result([&](void* value, std::size_t size) {
+    if (pos + size > data.size()) {
+      return false;
+    }
+    data.copy(static_cast<char*>(value), size, pos);
+    pos += size;
+    return true;
+  });
+}
+
+inline bool write_result(int fd, const TestPartResult& result) {
+  const auto data = serialize(result);
+  return write_all(fd, data.data(), data.size());
+}
+
+inline std::unique_ptr<TestPartResult> read_result(int fd) {
+  return parse_result(
+      [fd](void* data, std::size_t size) { return read_all(fd, data, size); });
+}
+#endif
+
+/**
+ * Failed test part results of the process, counted when they are reported
+ * (with `--gunit_journal`) or intercepted, so that a part of a test can tell
+ * whether it has failed
+ */
+inline std::atomic<std::size_t>& failures() {
+  static std::atomic<std::size_t> count{};
+  return count;
+}
+
+/**
+ * Intercepts test part results of the current thread (and all the other
+ * threads unless `current_thread_only`) for as long as it's alive
+ */
+class intercept_results {
+  class reporter : public ScopedFakeTestPartResultReporter {
+   public:
+    reporter(InterceptMode mode, intercept_results& self)
+        : ScopedFakeTestPartResultReporter{mode, nullptr}, self_{self} {}
+
+    void ReportTestPartResult(const TestPartResult& result) override {
+      if (result.failed()) {
+        ++failures();
+      }
+      const std::lock_guard<std::mutex> lock{self_.mutex_};
+      self_.on_result_(result);
+    }
+
+   private:
+    intercept_results& self_;
+  };
+
+ public:
+  explicit intercept_results(
+      std::function<void(const TestPartResult&)> on_result,
+      bool current_thread_only = false)
+      : on_result_{std::move(on_result)},
+        all_threads_{current_thread_only
+                         ? nullptr
+                         : std::make_unique<reporter>(
+                               ScopedFakeTestPartResultReporter::
+                                   INTERCEPT_ALL_THREADS,
+                               *this)} {}
+
+ private:
+  std::function<void(const TestPartResult&)> on_result_{};
+  std::mutex mutex_{};
+  std::unique_ptr<reporter> all_threads_{};
+  reporter current_thread_{
+      ScopedFakeTestPartResultReporter::INTERCEPT_ONLY_CURRENT_THREAD, *this};
+};
+
+/**
+ * Reports the result as if it happened in the current test
+ */
+inline void report(const TestPartResult& result) {
+  internal::AssertHelper(result.type(), result.file_name(),
+                         result.line_number(), result.message()) = Message();
+}
+
+inline void report_failure(const std::string& message) {
+  internal::AssertHelper(TestPartResult::kFatalFailure, nullptr, -1,
+                         message.c_str()) = Message();
+}
+
+/**
+ * Reports the exception being handled (call from a `catch (...)` block) as a
+ * failure, `where` it was thrown - "in the test body", "in the section", ...
+ */
+inline void report_exception(const std::string& where) {
+  try {
+    throw;
+  } catch (const std::exception& e) {
+    report_failure(std::string{"C++ exception with description \""} +
+                   e.what() + "\" thrown " + where + '.');
+  } catch (...) {
+    report_failure("Unknown C++ exception thrown " + where + '.');
+  }
+}
+
+/**
+ * Observes test part results of the current thread, which are still reported
+ * as usual (recorded in the current test, so `HasFatalFailure()` and
+ * `ASSERT_NO_FATAL_FAILURE` see them, and printed) for as long as it's alive
+ */
+class observe_results : public internal::HasNewFatalFailureHelper {
+ public:
+  explicit observe_results(
+      std::function<void(const TestPartResult&)> on_result)
+      : on_result_{std::move(on_result)} {}
+
+  void ReportTestPartResult(const TestPartResult& result) override {
+    on_result_(result);
+    const auto observed = std::exchange(observing(), true);
+    HasNewFatalFailureHelper::ReportTestPartResult(result);
+    observing() = observed;
+  }
+
+  /**
+   * @return true while an observed result is being reported by the current
+   * thread
+   */
+  static bool& observing() {
+    static thread_local bool observing{};
+    return observing;
+  }
+
+ private:
+  std::function<void(const TestPartResult&)> on_result_{};
+};
+
+/**
+ * Forwards test part results of a child process to its parent, which reports
+ * them
+ *
+ * The results are still recorded in the child (`HasFatalFailure()`,
+ * `RecordProperty` work as usual) but not printed. Results of the current
+ * thread are observed before they reach the reporter (so they are forwarded
+ * even if it has been replaced by `ScopedFakeTestPartResultReporter`), the
+ * ones of the other threads when they are reported.
+ */
+class forward_results : public EmptyTestEventListener {
+ public:
+  /**
+   * Installs (replaces, in a child of a child) the forwarding
+   */
+  static void install(std::function<void(const TestPartResult&)> on_result) {
+    auto& listeners = UnitTest::GetInstance()->listeners();
+    delete listeners.Release(listeners.default_result_printer());
+    delete listeners.Release(listeners.default_xml_generator());
+    if (!instance()) {
+      instance() = new forward_results{};
+      listeners.Append(instance());  // owned by gtest
+    }
+    instance()->on_result_ = std::move(on_result);
+    instance()->current_thread_.reset();
+    instance()->current_thread_ = std::make_unique<observe_results>(
+        [](const TestPartResult& result) { instance()->forward(result); });
+  }
+
+  static bool is_installed() { return instance(); }
+
+  void OnTestPartResult(const TestPartResult& result) override {
+    if (!observe_results::observing()) {
+      forward(result);
+    }
+  }
+
+ private:
+  static forward_results*& instance() {
+    static forward_results* forwarding{};
+    return forwarding;
+  }
+
+  void forward(const TestPartResult& result) {
+    if (result.failed()) {
+      ++failures();
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    on_result_(result);
+  }
+
+  std::function<void(const TestPartResult&)> on_result_{};
+  std::unique_ptr<observe_results> current_thread_{};
+  std::mutex mutex_{};
+};
+
+/**
+ * @return result of the current test, the ad hoc one outside of tests
+ */
+inline const TestResult& current_result() {
+  const auto test = UnitTest::GetInstance()->current_test_info();
+  return test ? *test->result() : UnitTest::GetInstance()->ad_hoc_test_result();
+}
+
+#if GUNIT_HAS_FORK
+/**
+ * Continues the execution in a child process
+ *
+ * Child: test part results (see `forward_results`) and properties recorded
+ * since the fork are sent to the parent, `finish` ends the process.
+ * Parent: `fork` returns when the child has finished, with the child results
+ * reported in the current test (plus a failure if the child crashed).
+ */
+class child_process {
+ public:
+  child_process() = default;
+  child_process(const child_process&) = delete;
+  child_process& operator=(const child_process&) = delete;
+
+  /**
+   * @return true in the child process, false in the parent process
+   */
+  bool fork(const std::string& name) {
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    int fds[2] = {};
+    if (::pipe(fds)) {
+      report_failure("Can't create a pipe for \"" + name + "\"");
+      return false;
+    }
+
+    const auto pid = ::fork();
+    if (pid < 0) {
+      ::close(fds[0]);
+      ::close(fds[1]);
+      report_failure("Can't fork \"" + name + "\"");
+      return false;
+    }
+
+    if (!pid) {
+      ::close(fds[0]);
+      forward_results::install([fd = fds[1]](const TestPartResult& result) {
+        const auto kind = RESULT;
+        write_all(fd, &kind, sizeof(kind)) && write_result(fd, result);
+      });
+      fd_ = fds[1];
+      properties_ = current_result().test_property_count();
+      return true;
+    }
+
+    ::close(fds[1]);
+    for (auto kind = RESULT; read_all(fds[0], &kind, sizeof(kind));) {
+      std::string key{}, value{};
+      if (kind == RESULT) {
+        const auto result = read_result(fds[0]);
+        if (!result) {
+          break;
+        }
+        report(*result);
+      } else if (kind == PROPERTY && read_string(fds[0], key) &&
+                 read_string(fds[0], value)) {
+        Test::RecordProperty(key, value);
+      } else {
+        break;
+      }
+    }
+    ::close(fds[0]);
+
+    int status{};
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (WIFSIGNALED(status)) {
+      report_failure("\"" + name + "\" crashed with signal " +
+                     std::to_string(WTERMSIG(status)));
+    } else if (WIFEXITED(status) && WEXITSTATUS(status)) {
+      report_failure("\"" + name + "\" exited with code " +
+                     std::to_string(WEXITSTATUS(status)));
+    }
+    return false;
+  }
+
+  bool is_child() const { return fd_ >= 0; }
+
+  [[noreturn]] void finish() {
+    const auto& result = current_result();
+    for (auto p = properties_; p < result.test_property_count(); ++p) {
+      const auto& property = result.GetTestProperty(p);
+      const auto kind = PROPERTY;
+      write_all(fd_, &kind, sizeof(kind)) &&
+          write_string(fd_, property.key()) &&
+          write_string(fd_, property.value());
+    }
+    ::close(fd_);
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    ::_exit(0);
+  }
+
+ private:
+  enum record : char { RESULT, PROPERTY };  // followed by its wire format
+
+  static bool write_string(int fd, const std::string& str) {
+    const auto size = std::int32_t(str.size());
+    return write_all(fd, &size, sizeof(size)) &&
+           write_all(fd, str.data(), str.size());
+  }
+
+  static bool read_string(int fd, std::string& str) {
+    std::int32_t size{};
+    if (!read_all(fd, &size, sizeof(size)) || size < 0) {
+      return false;
+    }
+    str.resize(std::size_t(size));
+    return read_all(fd, &str[0], str.size());
+  }
+
+  int fd_ = -1;
+  int properties_{};
+};
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
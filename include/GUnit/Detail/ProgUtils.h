@@ -101,12 +101,14 @@ inline auto &progname() {
   return self;
 }
 
-inline std::string call_stack(const std::string &newline, int stack_begin = 1,
-                              int stack_size = GUNIT_SHOW_STACK_SIZE) {
+/**
+ * @return symbolized call stack of the given return addresses (as captured by
+ * `backtrace`)
+ */
+inline std::string call_stack(void *const *bt, int frames,
+                              const std::string &newline, int stack_begin,
+                              int stack_size) {
 #if GUNIT_HAS_BACKTRACE
-  static constexpr auto MAX_CALL_STACK_SIZE = 64;
-  void *bt[MAX_CALL_STACK_SIZE];
-  const auto frames = backtrace(bt, sizeof(bt) / sizeof(bt[0]));
   const auto symbols = backtrace_symbols(bt, frames);
   std::shared_ptr<char*> free{symbols, [](char** p) { std::free(p); }};
   std::stringstream result;
@@ -136,6 +138,8 @@ inline std::string call_stack(const std::string &newline, int stack_begin = 1,
   }
   return result.str();
 #else
+  (void)bt;
+  (void)frames;
   (void)newline;
   (void)stack_begin;
   (void)stack_size;
@@ -143,6 +147,18 @@ inline std::string call_stack(const std::string &newline, int stack_begin = 1,
 #endif
 }
 
+inline std::string call_stack(const std::string &newline, int stack_begin = 1,
+                              int stack_size = GUNIT_SHOW_STACK_SIZE) {
+#if GUNIT_HAS_BACKTRACE
+  static constexpr auto MAX_CALL_STACK_SIZE = 64;
+  void *bt[MAX_CALL_STACK_SIZE];
+  const auto frames = backtrace(bt, sizeof(bt) / sizeof(bt[0]));
+  return call_stack(bt, frames, newline, stack_begin, stack_size);
+#else
+  return call_stack(nullptr, 0, newline, stack_begin, stack_size);
+#endif
+}
+
 inline std::pair<std::string, int> addr2line(void *addr) {
 #if GUNIT_HAS_ADDR2LINE
   std::stringstream cmd;
@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GUNIT_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define GUNIT_HAS_X86_SIMD 0
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * @return index of the first different byte from `i`, `size` if there is none
+ */
+inline std::size_t scalar_mismatch(const std::uint8_t* lhs,
+                                   const std::uint8_t* rhs, std::size_t size,
+                                   std::size_t i = 0) {
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+    std::uint64_t l{}, r{};
+    std::memcpy(&l, lhs + i, sizeof(l));
+    std::memcpy(&r, rhs + i, sizeof(r));
+    if (l != r) {
+      break;
+    }
+  }
+  for (; i < size && lhs[i] == rhs[i]; ++i) {
+  }
+  return i;
+}
+
+#if GUNIT_HAS_X86_SIMD
+__attribute__((target("sse2"))) inline std::size_t sse2_mismatch(
+    const std::uint8_t* lhs, const std::uint8_t* rhs, std::size_t size,
+    std::size_t i = 0) {
+  for (; i + 16 <= size; i += 16) {
+    const auto l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    const auto equal = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)));
+    if (equal != 0xffffu) {
+      return i + unsigned(__builtin_ctz(~equal));
+    }
+  }
+  return scalar_mismatch(lhs, rhs, size, i);
+}
+
+__attribute__((target("avx2"))) inline std::size_t avx2_mismatch(
+    const std::uint8_t* lhs, const std::uint8_t* rhs, std::size_t size) {
+  std::size_t i{};
+  for (; i + 32 <= size; i += 32) {
+    const auto l =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto r =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    const auto equal = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+    if (equal != 0xffffffffu) {
+      return i + unsigned(__builtin_ctz(~equal));
+    }
+  }
+  return sse2_mismatch(lhs, rhs, size, i);
+}
+#endif
+
+/**
+ * Vectorized (AVX2 if the CPU supports it, SSE2, 8 bytes words otherwise)
+ * comparison of `size` bytes
+ *
+ * @return index of the first different byte, `size` if they are equal
+ */
+inline std::size_t mismatch(const void* lhs, const void* rhs,
+                            std::size_t size) {
+  const auto l = static_cast<const std::uint8_t*>(lhs);
+  const auto r = static_cast<const std::uint8_t*>(rhs);
+#if GUNIT_HAS_X86_SIMD
+  static const auto avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return avx2 ? avx2_mismatch(l, r, size) : sse2_mismatch(l, r, size);
+#else
+  return scalar_mismatch(l, r, size);
+#endif
+}
+
+/**
+ * Elements which are equal if (and only if) their bytes are
+ */
+template <class T>
+constexpr auto is_bytewise_comparable =
+    std::is_integral<T>::value || std::is_enum<T>::value ||
+    std::is_pointer<T>::value;
+
+template <class T, class = void>
+struct is_contiguous : std::false_type {};
+
+template <class T>
+struct is_contiguous<T, std::void_t<decltype(std::data(std::declval<T&>())),
+                                    decltype(std::size(std::declval<T&>()))>>
+    : std::true_type {};
+
+template <class T>
+using element_t = std::remove_cv_t<
+    std::remove_reference_t<decltype(*std::begin(std::declval<T&>()))>>;
+
+/**
+ * Formats elements around the first mismatch, aligned so that a caret line
+ * points at it (bytes are formatted as hex)
+ */
+class mismatch_window {
+ public:
+  static constexpr std::size_t context = 8;  // elements on each side
+
+  explicit mismatch_window(std::size_t index)
+      : index_{index}, begin_{index > context ? index - context : 0} {}
+
+  std::size_t begin() const { return begin_; }
+  std::size_t end() const { return index_ + context + 1; }
+
+  template <class T>
+  static std::string format(const T& element) {
+    if constexpr (sizeof(T) == 1 && (std::is_integral<T>::value ||
+                                     std::is_enum<T>::value)) {
+      char hex[3]{};
+      std::snprintf(hex, sizeof(hex), "%02x",
+                    unsigned(std::uint8_t(element)));
+      return hex;
+    } else {
+      return PrintToString(element);
+    }
+  }
+
+  /**
+   * @param elements formatted elements of both ranges from `begin()`
+   */
+  std::string str(const std::string& lhs_expr, const std::string& rhs_expr,
+                  const std::vector<std::string>& lhs,
+                  const std::vector<std::string>& rhs) const {
+    std::size_t width{};
+    for (const auto& elements : {&lhs, &rhs}) {
+      for (const auto& element : *elements) {
+        width = std::max(width, element.size());
+      }
+    }
+    const auto lhs_label = label(lhs_expr, lhs.size());
+    const auto rhs_label = label(rhs_expr, rhs.size());
+    const auto indent = std::max(lhs_label.size(), rhs_label.size());
+    const auto row = [&](const std::string& name,
+                         const std::vector<std::string>& elements) {
+      auto result = "  " + name + std::string(indent - name.size(), ' ');
+      for (const auto& element : elements) {
+        result += ' ' + std::string(width - element.size(), ' ') + element;
+      }
+      return result + '\n';
+    };
+    return row(lhs_label, lhs) + row(rhs_label, rhs) + "  " +
+           std::string(indent + (index_ - begin_) * (width + 1) + 1, ' ') +
+           std::string(width, '^');
+  }
+
+ private:
+  std::string label(const std::string& expr, std::size_t size) const {
+    return expr + '[' + std::to_string(begin_) + ".." +
+           std::to_string(begin_ + size) + "):";
+  }
+
+  std::size_t index_{};
+  std::size_t begin_{};
+};
+
+/**
+ * `EXPECT_RANGE_EQ(actual, expected)` predicate formatter, contiguous ranges
+ * of integers, enums or pointers are compared with `mismatch`, other ones
+ * element by element
+ */
+template <class TLhs, class TRhs>
+AssertionResult range_eq(const char* lhs_expr, const char* rhs_expr,
+                         const TLhs& lhs, const TRhs& rhs) {
+  const auto lhs_size =
+      std::size_t(std::distance(std::begin(lhs), std::end(lhs)));
+  const auto rhs_size =
+      std::size_t(std::distance(std::begin(rhs), std::end(rhs)));
+  const auto size = std::min(lhs_size, rhs_size);
+
+  std::size_t index{};
+  using type = element_t<const TLhs>;
+  if constexpr (is_contiguous<const TLhs>::value &&
+                is_contiguous<const TRhs>::value &&
+                std::is_same<type, element_t<const TRhs>>::value &&
+                is_bytewise_comparable<type>) {
+    index = mismatch(std::data(lhs), std::data(rhs), size * sizeof(type)) /
+            sizeof(type);
+  } else {
+    auto l = std::begin(lhs);
+    auto r = std::begin(rhs);
+    for (; index < size && *l == *r; ++index, ++l, ++r) {
+    }
+  }
+  if (index == size && lhs_size == rhs_size) {
+    return AssertionSuccess();
+  }
+
+  const mismatch_window window{index};
+  const auto format = [&window](const auto& range, std::size_t range_size) {
+    std::vector<std::string> elements{};
+    auto it = std::begin(range);
+    std::advance(it, window.begin());
+    for (auto i = window.begin(); i < std::min(window.end(), range_size);
+         ++i, ++it) {
+      elements.push_back(mismatch_window::format(*it));
+    }
+    return elements;
+  };
+  return AssertionFailure()
+         << "Expected equality of these ranges:\n  " << lhs_expr
+         << "\n    Which is: " << lhs_size << " element(s)\n  " << rhs_expr
+         << "\n    Which is: " << rhs_size << " element(s)\n"
+         << (index < size ? "First mismatch at index "
+                          : "Ranges differ in size from index ")
+         << index << ":\n"
+         << window.str(lhs_expr, rhs_expr, format(lhs, lhs_size),
+                       format(rhs, rhs_size));
+}
+
+/**
+ * `EXPECT_BYTES_EQ(lhs, rhs, size)` predicate formatter
+ */
+inline AssertionResult bytes_eq(const char* lhs_expr, const char* rhs_expr,
+                                const char* size_expr, const void* lhs,
+                                const void* rhs, std::size_t size) {
+  const auto index = mismatch(lhs, rhs, size);
+  if (index == size) {
+    return AssertionSuccess();
+  }
+
+  const mismatch_window window{index};
+  const auto format = [&window, size](const void* bytes) {
+    std::vector<std::string> elements{};
+    const auto data = static_cast<const std::uint8_t*>(bytes);
+    for (auto i = window.begin(); i < std::min(window.end(), size); ++i) {
+      elements.push_back(mismatch_window::format(data[i]));
+    }
+    return elements;
+  };
+  return AssertionFailure()
+         << "Expected equality of " << size_expr
+         << " bytes of these values:\n  " << lhs_expr << "\n  " << rhs_expr
+         << "\nFirst mismatch at byte " << index << " of " << size << ":\n"
+         << window.str(lhs_expr, rhs_expr, format(lhs), format(rhs));
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
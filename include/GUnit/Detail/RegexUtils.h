@@ -7,6 +7,7 @@
 //
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -74,18 +75,32 @@ inline auto match(T pattern, const std::string& str) {
          std::string{pattern.c_str()} == remove_comments(str);
 }
 
+/**
+ * Matches `str` against a `--gtest_filter` wildcard pattern (terminated by
+ * '\0' or ':')
+ *
+ * Greedy, backtracking only to the last '*' (O(pattern * str) in the worst
+ * case instead of exponential).
+ */
 inline bool PatternMatchesString(const char* pattern, const char* str) {
-  switch (*pattern) {
-    case '\0':
-    case ':':  // Either ':' or '\0' marks the end of the pattern.
-      return *str == '\0';
-    case '?':  // Matches any single character.
-      return *str != '\0' && PatternMatchesString(pattern + 1, str + 1);
-    case '*':  // Matches any string (possibly empty) of characters.
-      return (*str != '\0' && PatternMatchesString(pattern, str + 1)) ||
-             PatternMatchesString(pattern + 1, str);
-    default:  // Non-special character.  Matches itself.
-      return *pattern == *str && PatternMatchesString(pattern + 1, str + 1);
+  const char* star = nullptr;
+  const char* resume = nullptr;
+  for (;;) {
+    const auto end = *pattern == '\0' || *pattern == ':';
+    if (!end && *pattern == '*') {  // Matches any string (possibly empty).
+      star = pattern++;
+      resume = str;
+    } else if (*str == '\0' && end) {
+      return true;
+    } else if (*str != '\0' && !end &&
+               (*pattern == '?' || *pattern == *str)) {
+      ++pattern, ++str;
+    } else if (star && *resume != '\0') {  // Let the last '*' eat one more.
+      pattern = star + 1;
+      str = ++resume;
+    } else {
+      return false;
+    }
   }
 }
 
@@ -109,28 +124,74 @@ inline bool MatchesFilter(const std::string& name, const char* filter) {
   }
 }
 
-inline bool FilterMatchesShould(const std::string& name,
-                                const std::string& should) {
-  // Split --gtest_filter at '-', if there is one, to separate into
-  // positive filter and negative filter portions
-  const char* const p = should.c_str();
-  const char* const dash = strchr(p, '-');
-  std::string positive;
-  std::string negative;
-  if (dash == nullptr) {
-    positive = should.c_str();  // Whole string is a positive filter
-    negative = "";
-  } else {
-    positive = std::string(p, dash);   // Everything up to the dash
-    negative = std::string(dash + 1);  // Everything after the dash
-    if (positive.empty()) {
-      // Treat '-test1' as the same as '*-test1'
-      positive = "*";
+/**
+ * `--gtest_filter` (`positive[:positive...][-negative[:negative...]]`) split
+ * into its patterns once, so matching a name doesn't parse nor copy anything
+ */
+class filter {
+  struct pattern {
+    enum { any, exact, wildcard } kind{};
+    std::string str{};
+  };
+
+ public:
+  explicit filter(const std::string& str = "*") {
+    const auto dash = str.find('-');
+    // Treat '-test1' as the same as '*-test1'
+    split(dash == 0 ? "*" : str.substr(0, dash), positive_);
+    if (dash != std::string::npos) {
+      split(str.substr(dash + 1), negative_);
     }
   }
 
-  return MatchesFilter(name, positive.c_str()) &&
-         !MatchesFilter(name, negative.c_str());
+  bool operator()(const char* name) const {
+    return matches(positive_, name) && !matches(negative_, name);
+  }
+
+ private:
+  static void split(const std::string& str, std::vector<pattern>& patterns) {
+    for (std::size_t begin = 0, end = 0; end != std::string::npos;
+         begin = end + 1) {
+      end = str.find(':', begin);
+      auto p = str.substr(begin, end - begin);
+      if (p.find_first_not_of('*') == std::string::npos && !p.empty()) {
+        patterns.push_back({pattern::any, {}});
+      } else {
+        const auto kind = p.find_first_of("*?") == std::string::npos
+                              ? pattern::exact
+                              : pattern::wildcard;
+        patterns.push_back({kind, std::move(p)});
+      }
+    }
+  }
+
+  static bool matches(const std::vector<pattern>& patterns, const char* name) {
+    for (const auto& p : patterns) {
+      switch (p.kind) {
+        case pattern::any:
+          return true;
+        case pattern::exact:
+          if (p.str == name) {
+            return true;
+          }
+          break;
+        case pattern::wildcard:
+          if (PatternMatchesString(p.str.c_str(), name)) {
+            return true;
+          }
+          break;
+      }
+    }
+    return false;
+  }
+
+  std::vector<pattern> positive_{};
+  std::vector<pattern> negative_{};
+};
+
+inline bool FilterMatchesShould(const std::string& name,
+                                const std::string& should) {
+  return filter{should}(name.c_str());
 }
 
 }  // namespace detail
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/RegexUtils.h"
+#include "GUnit/Detail/ServerUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * Tests registered by static initializers, made known to Google Test once its
+ * flags are parsed, only the ones matching `--gtest_filter`
+ *
+ * Entries are the static registrars themselves (linked in the registration
+ * order), so static initialization neither allocates nor builds any names.
+ * They are registered from a generator of a hidden parametrized test suite,
+ * which Google Test evaluates in InitGoogleTest (or RUN_ALL_TESTS), before the
+ * tests are filtered, so they follow the plain TESTs in the run order. The
+ * suite is installed by every binary including this header, so
+ * `--gunit_server` is served (from the generator) even without any GUnit
+ * test.
+ */
+class lazy_registry {
+ public:
+  struct entry {
+    void (*register_test)(void* self, const filter&){};
+    void* self{};
+    entry* next{};
+  };
+
+  static void add(entry& e) {
+    install();
+    if (registered()) {  // e.g. a test library loaded at run time
+      e.register_test(e.self, filter{GTEST_FLAG(filter)});
+      return;
+    }
+    (tail() ? tail()->next : head()) = &e;
+    tail() = &e;
+  }
+
+  /**
+   * Installs the hidden suite (once)
+   */
+  static bool install() {
+    static const auto installed = [] {
+      auto& holder = *UnitTest::GetInstance()
+                          ->parameterized_test_registry()
+                          .GetTestSuitePatternHolder<suite>(
+                              name, {__FILE__, __LINE__});
+      holder.AddTestPattern(name, name,
+                            new internal::TestMetaFactory<suite>(),
+                            {__FILE__, __LINE__});
+      holder.AddTestSuiteInstantiation("", &register_tests, &param_name,
+                                       __FILE__, __LINE__);
+#if defined(GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST)
+      internal::MarkAsIgnored{name};  // it never generates any test
+#endif
+      return true;
+    }();
+    return installed;
+  }
+
+ private:
+  struct suite : TestWithParam<int> {
+    void TestBody() override {}
+  };
+
+  static constexpr auto name = "GUnitLazyRegistry";
+
+  static entry*& head() {
+    static entry* e{};
+    return e;
+  }
+
+  static entry*& tail() {
+    static entry* e{};
+    return e;
+  }
+
+  static bool& registered() {
+    static bool r{};
+    return r;
+  }
+
+  static internal::ParamGenerator<int> register_tests() {
+    // the server forks a child per request, so all of them are registered
+    // (and GSTEPS features parsed) once, before it starts
+    const auto serving = !flag("server").empty();
+    registered() = true;
+    const filter f{serving ? "*" : GTEST_FLAG(filter)};
+    for (auto e = head(); e; e = e->next) {
+      e->register_test(e->self, f);
+    }
+    serve();  // with `--gunit_server` returns in the child processes only
+    return ValuesIn(std::vector<int>{});
+  }
+
+  static std::string param_name(const TestParamInfo<int>&) { return {}; }
+};
+
+inline const auto lazy_registry_installed = lazy_registry::install();
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,761 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/JournalUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+#include "GUnit/Detail/StatsUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * Wall times of tests and SHOULD sections (and failed tests) of the previous
+ * runs, used to run the failed and the longest tests first
+ *
+ * Stored as `<microseconds> <failed> <name>` lines in `<binary>.gunit_timings`
+ * when running with `--gunit_jobs`/`--gunit_threads`, in the given file with
+ * `--gunit_timings=<file>` (`--gunit_timings` for the default one), disabled
+ * with `--gunit_timings=0`. Entries of tests which haven't been run are kept.
+ */
+class timings_journal {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  struct entry {
+    std::uint64_t us{};
+    bool failed{};
+  };
+
+  explicit timings_journal(std::string file) : file_{std::move(file)} {
+    if (file_.empty()) {
+      return;
+    }
+    std::ifstream in{file_};
+    for (std::string line{}; std::getline(in, line);) {
+      std::string name{};
+      entry e{};
+      if (parse(line, name, e)) {
+        previous_[name] = e;
+      }
+    }
+  }
+
+  bool is_enabled() const { return !file_.empty(); }
+
+  /**
+   * @return entry of the previous run, nullptr if there is none
+   */
+  const entry* find(const std::string& name) const {
+    const auto it = previous_.find(name);
+    return it == previous_.end() ? nullptr : &it->second;
+  }
+
+  /**
+   * Orders to run first: failed, unknown (new), the longest
+   */
+  bool before(const std::string& lhs, const std::string& rhs) const {
+    const auto key = [this](const std::string& name) {
+      const auto e = find(name);
+      return std::make_tuple(e && e->failed, !e, e ? e->us : 0);
+    };
+    return key(lhs) > key(rhs);
+  }
+
+  void record(const std::string& name, clock::duration elapsed,
+              bool failed = false) {
+    record(name,
+           {std::uint64_t(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                    .count()),
+            failed});
+  }
+
+  void record(const std::string& name, const entry& e) {
+    if (!is_enabled()) {
+      return;
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    if (forward_) {
+      forward_(format(name, e));
+    } else {
+      current_[name] = e;
+    }
+  }
+
+  /**
+   * Forwards records (as lines) instead of storing them (worker processes)
+   */
+  void forward(std::function<void(const std::string&)> f) {
+    const std::lock_guard<std::mutex> lock{mutex_};
+    forward_ = std::move(f);
+  }
+
+  void save() const {
+    if (!is_enabled() || current_.empty()) {
+      return;
+    }
+    auto all = previous_;
+    for (const auto& e : current_) {
+      all[e.first] = e.second;
+    }
+    const auto tmp = file_ + ".tmp";
+    {
+      std::ofstream out{tmp};
+      for (const auto& e : all) {
+        out << format(e.first, e.second);
+      }
+      if (!out) {
+        std::remove(tmp.c_str());
+        return;
+      }
+    }
+    std::rename(tmp.c_str(), file_.c_str());
+  }
+
+  static std::string format(const std::string& name, const entry& e) {
+    return std::to_string(e.us) + (e.failed ? " 1 " : " 0 ") + name + '\n';
+  }
+
+  static bool parse(const std::string& line, std::string& name, entry& e) {
+    const auto first = line.find(' ');
+    if (first == std::string::npos || first + 3 > line.size() ||
+        line[first + 2] != ' ') {
+      return false;
+    }
+    char* end{};
+    e.us = std::strtoull(line.c_str(), &end, 10);
+    if (end != line.c_str() + first) {
+      return false;
+    }
+    e.failed = line[first + 1] == '1';
+    name = line.substr(first + 3);
+    if (!name.empty() && name.back() == '\n') {
+      name.pop_back();
+    }
+    return !name.empty();
+  }
+
+ private:
+  std::string file_{};
+  std::unordered_map<std::string, entry> previous_{};
+  std::map<std::string, entry> current_{};
+  std::function<void(const std::string&)> forward_{};
+  std::mutex mutex_{};
+};
+
+inline std::string timings_file_default() {
+  const auto& argv = internal::GetArgvs();
+  return argv.empty() ? "" : argv.front() + ".gunit_timings";
+}
+
+/**
+ * @return `--gunit_threads` (sections and parameters run concurrently), read
+ * once
+ */
+inline std::size_t threads_flag() {
+  static const std::size_t threads =
+      std::strtoul(flag("threads").c_str(), nullptr, 10);
+  return threads;
+}
+
+inline std::string timings_file() {
+  const auto file = flag("timings");
+  if (file.empty()) {
+    const auto parallel =
+        std::strtoul(flag("jobs").c_str(), nullptr, 10) > 1 ||
+        threads_flag() > 1;
+    return parallel ? timings_file_default() : "";
+  }
+  if (file == "1") {
+    return timings_file_default();
+  }
+  return is_flag_enabled("timings") ? file : "";
+}
+
+inline timings_journal& timings() {
+  static timings_journal journal{timings_file()};
+  return journal;
+}
+
+inline std::string test_name(const TestInfo& info) {
+  return std::string{info.test_suite_name()} + '.' + info.name();
+}
+
+/**
+ * `--gunit_jobs=N` (GUNIT_JOBS=N) runs GTESTs in N worker processes
+ *
+ * Workers are forked when all the global environments have been set up
+ * (static registration, gtest initialization and the environments happen
+ * once) and claim tests from a queue shared with the parent. Every claimed
+ * test runs in a child process of its worker, reported as usual there (so
+ * `HasFatalFailure()`, `ASSERT_NO_FATAL_FAILURE` and `RecordProperty` see
+ * only the test), its results, properties and output are streamed back. The
+ * parent still walks the tests in gtest order and reports every GTEST from
+ * its worker results (or runs it itself if nobody has claimed it yet), so
+ * listeners, XML/JSON output and the summary stay unified.
+ * Parametrized GTESTs and plain TESTs run in the parent.
+ */
+class jobs_runner : public EmptyTestEventListener {
+  struct test {
+    const TestInfo* info{};
+    std::function<void()> run{};
+  };
+
+ public:
+  void add(const TestInfo* info, std::function<void()> run) {
+    tests_.push_back({info, std::move(run)});
+  }
+
+  bool is_worker() const { return worker_; }
+
+  /**
+   * @return the test being run by the current (worker) process
+   */
+  const TestInfo* current_test() const {
+    return worker_ ? current_ : UnitTest::GetInstance()->current_test_info();
+  }
+
+#if GUNIT_HAS_FORK
+  /**
+   * @return true if the current test has been run by a worker and its
+   * results have been reported, false if it has to be run by the caller
+   */
+  bool replay() {
+    if (worker_ || jobs_.empty()) {
+      return false;
+    }
+    const auto it = index_.find(UnitTest::GetInstance()->current_test_info());
+    if (it == index_.end() || !claims_[it->second].exchange(true)) {
+      return false;
+    }
+
+    auto& j = jobs_[it->second];
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      done_.wait(lock, [&j] { return j.done; });
+    }
+    std::cout << j.output << std::flush;
+    for (const auto& result : j.results) {
+      report(result);
+    }
+    for (const auto& property : j.properties) {
+      Test::RecordProperty(property.first, property.second);
+    }
+    return true;
+  }
+
+  void OnEnvironmentsSetUpEnd(const UnitTest&) override {
+    const auto workers = std::strtoul(flag("jobs").c_str(), nullptr, 10);
+    if (workers < 2 || worker_ || Test::HasFatalFailure() ||
+        Test::IsSkipped()) {
+      return;  // tests won't run
+    }
+
+    for (const auto& t : tests_) {
+      if (t.info->should_run()) {
+        jobs_.push_back(job{&t});
+      }
+    }
+    if (jobs_.empty()) {
+      return;
+    }
+    // workers claim failed and the longest tests first
+    std::stable_sort(jobs_.begin(), jobs_.end(),
+                     [](const job& lhs, const job& rhs) {
+                       return timings().before(test_name(*lhs.t->info),
+                                               test_name(*rhs.t->info));
+                     });
+    for (auto i = 0u; i < jobs_.size(); ++i) {
+      index_[jobs_[i].t->info] = i;
+    }
+
+    const auto size = sizeof(std::atomic<std::size_t>) +
+                      jobs_.size() * sizeof(std::atomic<bool>);
+    shared_ = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared_ == MAP_FAILED) {
+      shared_ = nullptr;
+      jobs_.clear();
+      index_.clear();
+      return;
+    }
+    shared_size_ = size;
+    cursor_ = new (shared_) std::atomic<std::size_t>{};
+    claims_ = reinterpret_cast<std::atomic<bool>*>(cursor_ + 1);
+    for (auto i = 0u; i < jobs_.size(); ++i) {
+      new (&claims_[i]) std::atomic<bool>{};
+    }
+
+    std::cout.flush();
+    std::fflush(nullptr);
+    for (auto i = 0u; i < workers; ++i) {
+      int fds[2] = {};
+      if (::pipe(fds)) {
+        break;
+      }
+      const auto pid = ::fork();
+      if (!pid) {
+        ::close(fds[0]);
+        for (const auto& w : workers_) {
+          ::close(w.fd);
+        }
+        worker_ = true;
+        work(fds[1]);
+        std::fflush(nullptr);
+        ::_exit(0);
+      }
+      ::close(fds[1]);
+      if (pid < 0) {
+        ::close(fds[0]);
+        break;
+      }
+      workers_.push_back({pid, fds[0]});
+    }
+    reader_ = std::thread{[this] { read(); }};
+  }
+
+  /**
+   * @return worker wall time of the test, zero if it has been run by the
+   * caller
+   */
+  timings_journal::clock::duration elapsed(const TestInfo& info) const {
+    const auto it = index_.find(&info);
+    return it == index_.end() ? timings_journal::clock::duration{}
+                              : jobs_[it->second].elapsed;
+  }
+
+  void OnEnvironmentsTearDownStart(const UnitTest&) override {
+    if (reader_.joinable()) {
+      reader_.join();
+    }
+    if (shared_) {
+      ::munmap(shared_, shared_size_);
+      shared_ = nullptr;
+    }
+    workers_.clear();
+    jobs_.clear();
+    index_.clear();
+  }
+
+ private:
+  enum frame : std::uint8_t {
+    START,
+    RESULT,
+    PROPERTY,
+    OUTPUT,
+    TIMING,
+    STATS,
+    DONE
+  };
+
+  struct job {
+    const test* t{};
+    bool done{};
+    timings_journal::clock::duration elapsed{};
+    std::string output{};
+    std::vector<TestPartResult> results{};
+    std::vector<std::pair<std::string, std::string>> properties{};
+  };
+
+  struct worker {
+    pid_t pid{};
+    int fd{};
+    std::int64_t job = -1;
+  };
+
+  static bool send(int fd, frame type, std::uint32_t job,
+                   const std::string& payload = {}) {
+    std::string data{};
+    data += char(type);
+    data.append(reinterpret_cast<const char*>(&job), sizeof(job));
+    const auto size = std::uint32_t(payload.size());
+    data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    data += payload;
+    return write_all(fd, data.data(), data.size());
+  }
+
+  std::int64_t claim() {
+    for (auto i = cursor_->load(); i < jobs_.size(); ++i) {
+      if (!claims_[i].exchange(true)) {
+        cursor_->store(i + 1);
+        return std::int64_t(i);
+      }
+    }
+    return -1;
+  }
+
+  void work(int fd) {
+    const auto out = std::tmpfile();
+    std::uint32_t current{};
+    timings().forward([fd, &current](const std::string& line) {
+      send(fd, TIMING, current, line);
+    });
+    stats().forward([fd, &current](const std::string& line) {
+      send(fd, STATS, current, line);
+    });
+    for (auto i = claim(); i >= 0; i = claim()) {
+      current = std::uint32_t(i);
+      current_ = jobs_[std::size_t(i)].t->info;
+      send(fd, START, current);
+      if (out) {
+        std::rewind(out);
+        (void)::ftruncate(::fileno(out), 0);
+      }
+      std::cout.flush();
+      std::fflush(nullptr);
+
+      const auto start = timings_journal::clock::now();
+      const auto pid = ::fork();
+      if (!pid) {
+        run(fd, current, out);
+      }
+      int status{};
+      while (pid > 0 && ::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+      }
+      const auto elapsed = timings_journal::clock::now() - start;
+
+      if (pid < 0) {
+        send(fd, RESULT, current,
+             serialize({TestPartResult::kFatalFailure, nullptr, -1,
+                        "Worker can't fork the test"}));
+      } else if (WIFSIGNALED(status) || WEXITSTATUS(status)) {
+        send(fd, RESULT, current,
+             serialize({TestPartResult::kFatalFailure, nullptr, -1,
+                        (WIFSIGNALED(status)
+                             ? "Test crashed with signal " +
+                                   std::to_string(WTERMSIG(status))
+                             : "Test exited with code " +
+                                   std::to_string(WEXITSTATUS(status)))
+                            .c_str()}));
+      }
+
+      std::string output{};
+      if (out) {
+        std::rewind(out);
+        char buffer[4096];
+        for (std::size_t n{};
+             (n = std::fread(buffer, 1, sizeof(buffer), out));) {
+          output.append(buffer, n);
+        }
+      }
+      send(fd, OUTPUT, current, output);
+      send(fd, DONE, current,
+           std::to_string(
+               std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                   .count()));
+    }
+  }
+
+  /**
+   * Runs the test `i` in the child process of a worker
+   */
+  [[noreturn]] void run(int fd, std::uint32_t i, std::FILE* out) {
+    if (out) {
+      ::dup2(::fileno(out), 1);
+      ::dup2(::fileno(out), 2);
+    }
+    forward_results::install([fd, i](const TestPartResult& result) {
+      send(fd, RESULT, i, serialize(result));
+    });
+    const auto& result = current_result();
+    const auto properties = result.test_property_count();
+    try {
+      jobs_[i].t->run();
+    } catch (...) {
+      report_exception("in the test body");
+    }
+    for (auto p = properties; p < result.test_property_count(); ++p) {
+      const auto& property = result.GetTestProperty(p);
+      send(fd, PROPERTY, i,
+           std::string{property.key()} + '\0' + property.value());
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    ::_exit(0);
+  }
+
+  void finish(std::size_t i, std::vector<TestPartResult> results = {}) {
+    const std::lock_guard<std::mutex> lock{mutex_};
+    auto& j = jobs_[i];
+    j.results.insert(j.results.end(), results.begin(), results.end());
+    j.done = true;
+    done_.notify_all();
+  }
+
+  void read() {
+    std::vector<pollfd> fds{};
+    for (const auto& w : workers_) {
+      fds.push_back({w.fd, POLLIN, 0});
+    }
+
+    for (auto alive = fds.size(); alive;) {
+      if (::poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      for (auto n = 0u; n < fds.size(); ++n) {
+        if (fds[n].fd < 0 || !fds[n].revents) {
+          continue;
+        }
+        auto& w = workers_[n];
+        if (!read_frame(w)) {
+          ::close(w.fd);
+          fds[n].fd = -1;
+          --alive;
+          int status{};
+          while (::waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {
+          }
+          if (w.job >= 0) {
+            finish(std::size_t(w.job),
+                   {TestPartResult{
+                       TestPartResult::kFatalFailure, nullptr, -1,
+                       (WIFSIGNALED(status)
+                            ? "Worker crashed with signal " +
+                                  std::to_string(WTERMSIG(status))
+                            : "Worker exited with code " +
+                                  std::to_string(WEXITSTATUS(status)))
+                           .c_str()}});
+          }
+        }
+      }
+    }
+
+    // tests claimed by workers which haven't started them
+    for (auto i = 0u; i < jobs_.size(); ++i) {
+      const std::lock_guard<std::mutex> lock{mutex_};
+      if (!jobs_[i].done) {
+        jobs_[i].results.push_back(
+            TestPartResult{TestPartResult::kFatalFailure, nullptr, -1,
+                           "Test hasn't been run by any worker"});
+        jobs_[i].done = true;
+      }
+    }
+    done_.notify_all();
+  }
+
+  bool read_frame(worker& w) {
+    std::uint8_t type{};
+    std::uint32_t i{}, size{};
+    if (!read_all(w.fd, &type, sizeof(type)) ||
+        !read_all(w.fd, &i, sizeof(i)) ||
+        !read_all(w.fd, &size, sizeof(size)) || i >= jobs_.size()) {
+      return false;
+    }
+    std::string payload(size, '\0');
+    if (!read_all(w.fd, &payload[0], payload.size())) {
+      return false;
+    }
+
+    switch (frame(type)) {
+      case START:
+        w.job = i;
+        break;
+      case RESULT:
+        if (const auto result = deserialize(payload)) {
+          const std::lock_guard<std::mutex> lock{mutex_};
+          jobs_[i].results.push_back(*result);
+        }
+        break;
+      case PROPERTY: {
+        const auto key = payload.find('\0');
+        if (key != std::string::npos) {
+          const std::lock_guard<std::mutex> lock{mutex_};
+          jobs_[i].properties.emplace_back(payload.substr(0, key),
+                                           payload.substr(key + 1));
+        }
+      } break;
+      case OUTPUT: {
+        const std::lock_guard<std::mutex> lock{mutex_};
+        jobs_[i].output += payload;
+      } break;
+      case TIMING: {
+        std::string name{};
+        timings_journal::entry e{};
+        if (timings_journal::parse(payload, name, e)) {
+          timings().record(name, e);
+        }
+      } break;
+      case STATS: {
+        section_stats s{};
+        if (stats_report::parse(payload, s)) {
+          stats().record(s);
+        }
+      } break;
+      case DONE:
+        w.job = -1;
+        {
+          const std::lock_guard<std::mutex> lock{mutex_};
+          jobs_[i].elapsed = std::chrono::microseconds{
+              std::strtoull(payload.c_str(), nullptr, 10)};
+        }
+        finish(i);
+        break;
+    }
+    return true;
+  }
+
+  bool worker_{};
+  const TestInfo* current_{};
+  std::vector<test> tests_{};
+  std::vector<job> jobs_{};
+  std::unordered_map<const TestInfo*, std::size_t> index_{};
+  void* shared_{};
+  std::size_t shared_size_{};
+  std::atomic<std::size_t>* cursor_{};
+  std::atomic<bool>* claims_{};
+  std::vector<worker> workers_{};
+  std::thread reader_{};
+  std::mutex mutex_{};
+  std::condition_variable done_{};
+#else
+  bool replay() { return false; }
+
+  timings_journal::clock::duration elapsed(const TestInfo&) const {
+    return {};
+  }
+
+ private:
+  bool worker_{};
+  const TestInfo* current_{};
+  std::vector<test> tests_{};
+#endif
+};
+
+/**
+ * Records wall times of the tests into the timings journal, saves the
+ * journal and the stats report at the end of the run
+ */
+class timings_recorder : public EmptyTestEventListener {
+ public:
+  explicit timings_recorder(const jobs_runner& runner) : runner_{runner} {}
+
+  void OnTestStart(const TestInfo&) override {
+    start_ = timings_journal::clock::now();
+  }
+
+  void OnTestEnd(const TestInfo& info) override {
+    auto elapsed = runner_.elapsed(info);
+    if (elapsed == timings_journal::clock::duration{}) {
+      elapsed = timings_journal::clock::now() - start_;
+    }
+    timings().record(test_name(info), elapsed, info.result()->Failed());
+  }
+
+  void OnTestProgramEnd(const UnitTest&) override {
+    timings().save();
+    stats().save();
+  }
+
+ private:
+  const jobs_runner& runner_;
+  timings_journal::clock::time_point start_{};
+};
+
+/**
+ * Appends tests starting, their failures and results to the results journal
+ * as they happen, tests run by `--gunit_jobs` workers when they are reported
+ */
+class journal_recorder : public EmptyTestEventListener {
+ public:
+  explicit journal_recorder(const jobs_runner& runner) : runner_{runner} {}
+
+  void OnTestStart(const TestInfo& info) override {
+    start_ = timings_journal::clock::now();
+    test_ = test_name(info);
+    journal().append(journal_kind::START, journal_status::PASSED, 0, test_);
+  }
+
+  void OnTestPartResult(const TestPartResult& result) override {
+    if (!result.failed() || forward_results::is_installed()) {
+      return;  // results of child processes are appended by their parent
+    }
+    ++failures();
+    journal().append(
+        journal_kind::FAILURE, journal_status::FAILED, 0, test_,
+        internal::FormatCompilerIndependentFileLocation(
+            result.file_name(), result.line_number()) +
+            '\n' + result.message());
+  }
+
+  void OnTestEnd(const TestInfo& info) override {
+    auto elapsed = runner_.elapsed(info);
+    if (elapsed == timings_journal::clock::duration{}) {
+      elapsed = timings_journal::clock::now() - start_;
+    }
+    const auto& result = *info.result();
+    journal().append(
+        journal_kind::TEST,
+        result.Failed()    ? journal_status::FAILED
+        : result.Skipped() ? journal_status::SKIPPED
+                           : journal_status::PASSED,
+        std::uint64_t(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                .count()),
+        test_);
+    test_.clear();
+  }
+
+ private:
+  const jobs_runner& runner_;
+  timings_journal::clock::time_point start_{};
+  std::string test_{};  // reported results hold the lock of current_test_info
+};
+
+inline jobs_runner& jobs() {
+  static const auto runner = [] {
+    const auto runner = new jobs_runner{};
+    // owned by gtest
+    UnitTest::GetInstance()->listeners().Append(runner);
+    UnitTest::GetInstance()->listeners().Append(new timings_recorder{*runner});
+    if (journal().is_enabled()) {
+      UnitTest::GetInstance()->listeners().Append(
+          new journal_recorder{*runner});
+    }
+    return runner;
+  }();
+  return *runner;
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
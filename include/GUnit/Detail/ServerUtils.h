@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+#if GUNIT_HAS_FORK
+/**
+ * Writes the results of the run as lines to `fd`
+ *
+ * START <test>
+ * FAILURE <file>:<line> <message (`\` and new lines escaped)>
+ * PASSED|FAILED|SKIPPED <test> <ms>
+ * END <passed> <failed>
+ */
+class result_stream : public EmptyTestEventListener {
+ public:
+  explicit result_stream(int fd) : fd_{fd} {}
+
+  void OnTestStart(const TestInfo& info) override {
+    send("START " + name(info));
+  }
+
+  void OnTestPartResult(const TestPartResult& result) override {
+    if (!result.failed()) {
+      return;
+    }
+    std::string message{};
+    for (const auto c : std::string{result.message()}) {
+      message += c == '\\' ? "\\\\" : c == '\n' ? "\\n" : std::string(1, c);
+    }
+    send("FAILURE " +
+         std::string{result.file_name() ? result.file_name() : "unknown"} +
+         ':' + std::to_string(result.line_number()) + ' ' + message);
+  }
+
+  void OnTestEnd(const TestInfo& info) override {
+    const auto& result = *info.result();
+    send(std::string{result.Failed()    ? "FAILED "
+                     : result.Skipped() ? "SKIPPED "
+                                        : "PASSED "} +
+         name(info) + ' ' + std::to_string(result.elapsed_time()));
+  }
+
+  void OnTestProgramEnd(const UnitTest& unit_test) override {
+    send("END " + std::to_string(unit_test.successful_test_count()) + ' ' +
+         std::to_string(unit_test.failed_test_count()));
+  }
+
+ private:
+  static std::string name(const TestInfo& info) {
+    return std::string{info.test_suite_name()} + '.' + info.name();
+  }
+
+  void send(const std::string& line) const {
+    const auto data = line + '\n';
+    write_all(fd_, data.data(), data.size());
+  }
+
+  int fd_{};
+};
+
+/**
+ * Resident test server listening on a Unix domain socket
+ *
+ * Every connection sends a gtest filter terminated by a new line (empty runs
+ * all tests, `quit` stops the server) and receives the results of a run
+ * (`result_stream`) done by a child process forked from the server, followed
+ * by `CRASHED <signal>` if the child has been killed.
+ */
+class server {
+ public:
+  explicit server(std::string path) : path_{std::move(path)} {
+    std::signal(SIGPIPE, SIG_IGN);  // clients might not read the results
+    sockaddr_un address{};
+    if (path_.size() >= sizeof(address.sun_path)) {
+      return;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(path_.c_str());
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ >= 0 &&
+        (::bind(fd_, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) ||
+         ::listen(fd_, 16))) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  server(const server&) = delete;
+  server& operator=(const server&) = delete;
+
+  ~server() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      ::unlink(path_.c_str());
+    }
+    if (client_ >= 0) {
+      ::close(client_);
+    }
+  }
+
+  bool is_listening() const { return fd_ >= 0; }
+
+  /**
+   * Serves requests until one has to be run
+   *
+   * @return true in the child process which has to run the tests matching
+   * `filter` and write the results to `client()`, false when the server has
+   * been stopped
+   */
+  bool next(std::string& filter) {
+    while (is_listening()) {
+      const auto client = ::accept(fd_, nullptr, nullptr);
+      if (client < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      filter = read_line(client);
+      if (filter == "quit") {
+        ::close(client);
+        break;
+      }
+      if (filter.empty()) {
+        filter = "*";
+      }
+
+      std::cout.flush();
+      std::fflush(nullptr);
+      const auto pid = ::fork();
+      if (!pid) {
+        ::close(fd_);
+        fd_ = -1;  // the child doesn't own the socket
+        client_ = client;
+        return true;
+      }
+      if (pid > 0) {
+        int status{};
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFSIGNALED(status)) {
+          const auto crashed =
+              "CRASHED " + std::to_string(WTERMSIG(status)) + '\n';
+          write_all(client, crashed.data(), crashed.size());
+        }
+      }
+      ::close(client);
+    }
+    return false;
+  }
+
+  int client() const { return client_; }
+
+ private:
+  static std::string read_line(int fd) {
+    std::string line{};
+    for (char c{}; ::read(fd, &c, 1) == 1 && c != '\n';) {
+      line += c;
+    }
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    return line;
+  }
+
+  std::string path_{};
+  int fd_ = -1;
+  int client_ = -1;
+};
+#endif
+
+/**
+ * `--gunit_server=<unix socket>` (GUNIT_SERVER=<unix socket>) keeps the test
+ * binary resident, every request runs the tests matching the requested filter
+ * in a child process forked from the initialized server
+ *
+ * Called before the tests are registered, returns in the child processes
+ * only (with the filter set), the server exits when it's stopped.
+ */
+inline void serve() {
+  const auto path = flag("server");
+  if (path.empty()) {
+    return;
+  }
+#if GUNIT_HAS_FORK
+  static server s{path};
+  if (!s.is_listening()) {
+    std::cerr << "Can't listen on \"" << path << "\"" << std::endl;
+    std::exit(1);
+  }
+  std::cout << "[  SERVER  ] " << path << std::endl;
+  std::string filter{};
+  if (!s.next(filter)) {
+    std::exit(0);
+  }
+  GTEST_FLAG(filter) = filter;
+  UnitTest::GetInstance()->listeners().Append(new result_stream{s.client()});
+#else
+  std::cerr << "--gunit_server is not supported on this platform" << std::endl;
+#endif
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
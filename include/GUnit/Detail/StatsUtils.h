@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+// Feature detection: getrusage support
+#if !defined(GUNIT_HAS_RUSAGE)
+  #if defined(__APPLE__) || defined(__linux__)
+    #define GUNIT_HAS_RUSAGE 1
+  #else
+    #define GUNIT_HAS_RUSAGE 0
+  #endif
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/AllocUtils.h"
+#include "GUnit/Detail/FlagUtils.h"
+
+#if GUNIT_HAS_RUSAGE
+#include <sys/resource.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+struct resource_usage {
+  std::chrono::steady_clock::time_point wall{};
+  std::chrono::nanoseconds cpu{};  // current thread and waited children
+  long max_rss_kb{};               // process
+  std::uint64_t allocations{};     // current thread
+  std::uint64_t allocated_bytes{};
+};
+
+/**
+ * @param all false to read the wall time only
+ */
+inline resource_usage current_usage(bool all = true) {
+  resource_usage usage{std::chrono::steady_clock::now()};
+  if (!all) {
+    return usage;
+  }
+#if GUNIT_HAS_RUSAGE
+  const auto cpu = [](const rusage& ru) {
+    return std::chrono::seconds{ru.ru_utime.tv_sec + ru.ru_stime.tv_sec} +
+           std::chrono::microseconds{ru.ru_utime.tv_usec + ru.ru_stime.tv_usec};
+  };
+  rusage self{}, children{};
+#if defined(RUSAGE_THREAD)
+  getrusage(RUSAGE_THREAD, &self);
+#else
+  getrusage(RUSAGE_SELF, &self);
+#endif
+  getrusage(RUSAGE_CHILDREN, &children);
+  usage.cpu = cpu(self) + cpu(children);
+#if defined(__APPLE__)
+  rusage process{};
+  getrusage(RUSAGE_SELF, &process);
+  usage.max_rss_kb = process.ru_maxrss / 1024;  // bytes
+#elif defined(RUSAGE_THREAD)
+  rusage process{};
+  getrusage(RUSAGE_SELF, &process);
+  usage.max_rss_kb = process.ru_maxrss;
+#else
+  usage.max_rss_kb = self.ru_maxrss;
+#endif
+#endif
+  usage.allocations = detail::allocations();
+  usage.allocated_bytes = detail::allocated_bytes();
+  return usage;
+}
+
+struct section_stats {
+  std::string test{};
+  std::string should{};
+  std::chrono::nanoseconds wall{};
+  std::chrono::nanoseconds cpu{};
+  long max_rss_delta_kb{};
+  std::uint64_t allocations{};
+  std::uint64_t allocated_bytes{};
+};
+
+inline section_stats make_section_stats(const std::string& test,
+                                        const std::string& should,
+                                        const resource_usage& start,
+                                        const resource_usage& end) {
+  return {test,
+          should,
+          end.wall - start.wall,
+          end.cpu - start.cpu,
+          end.max_rss_kb - start.max_rss_kb,
+          end.allocations - start.allocations,
+          end.allocated_bytes - start.allocated_bytes};
+}
+
+inline std::string to_string(const section_stats& s) {
+  const auto ms = [](std::chrono::nanoseconds ns) {
+    std::ostringstream str{};
+    str << std::fixed << std::setprecision(3) << ns.count() / 1e6 << " ms";
+    return str.str();
+  };
+  auto str = "wall " + ms(s.wall) + ", cpu " + ms(s.cpu) + ", max rss +" +
+             std::to_string(s.max_rss_delta_kb) + " kB";
+  if (has_allocations()) {
+    str += ", " + std::to_string(s.allocations) + " allocations (" +
+           std::to_string(s.allocated_bytes) + " bytes)";
+  }
+  return str;
+}
+
+/**
+ * Resource usage of the SHOULD sections
+ *
+ * Collected with `--gunit_stats` (printed after every section) or
+ * `--gunit_stats=<file>` (written to the file at the end of the run, as CSV
+ * if the file name ends with `.csv`, as JSON otherwise).
+ */
+class stats_report {
+ public:
+  explicit stats_report(std::string flag) : flag_{std::move(flag)} {}
+
+  bool is_enabled() const { return !flag_.empty(); }
+  bool is_printed() const { return flag_ == "1"; }
+
+  void record(const section_stats& s) {
+    if (!is_enabled()) {
+      return;
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    if (forward_) {
+      forward_(csv(s));
+    } else {
+      sections_.push_back(s);
+    }
+  }
+
+  /**
+   * Forwards records (as CSV lines) instead of storing them (worker processes)
+   */
+  void forward(std::function<void(const std::string&)> f) {
+    const std::lock_guard<std::mutex> lock{mutex_};
+    forward_ = std::move(f);
+  }
+
+  std::vector<section_stats> sections() const {
+    const std::lock_guard<std::mutex> lock{mutex_};
+    return sections_;
+  }
+
+  void save() const {
+    if (!is_enabled() || is_printed()) {
+      return;
+    }
+    std::ofstream out{flag_};
+    const auto is_csv =
+        flag_.size() >= 4 && !flag_.compare(flag_.size() - 4, 4, ".csv");
+    const std::lock_guard<std::mutex> lock{mutex_};
+    if (is_csv) {
+      out << "test,should,wall_ns,cpu_ns,max_rss_delta_kb,allocations,"
+             "allocated_bytes\n";
+      for (const auto& s : sections_) {
+        out << csv(s);
+      }
+      return;
+    }
+    out << "{\n  \"sections\": [";
+    for (auto i = 0u; i < sections_.size(); ++i) {
+      const auto& s = sections_[i];
+      out << (i ? ",\n" : "\n") << "    {\"test\": " << json(s.test)
+          << ", \"should\": " << json(s.should)
+          << ", \"wall_ns\": " << s.wall.count()
+          << ", \"cpu_ns\": " << s.cpu.count()
+          << ", \"max_rss_delta_kb\": " << s.max_rss_delta_kb
+          << ", \"allocations\": " << s.allocations
+          << ", \"allocated_bytes\": " << s.allocated_bytes << '}';
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  static std::string csv(const section_stats& s) {
+    return csv(s.test) + ',' + csv(s.should) + ',' +
+           std::to_string(s.wall.count()) + ',' +
+           std::to_string(s.cpu.count()) + ',' +
+           std::to_string(s.max_rss_delta_kb) + ',' +
+           std::to_string(s.allocations) + ',' +
+           std::to_string(s.allocated_bytes) + '\n';
+  }
+
+  static bool parse(const std::string& line, section_stats& s) {
+    std::vector<std::string> fields{1};
+    auto quoted = false;
+    for (auto i = 0u; i < line.size(); ++i) {
+      const auto c = line[i];
+      if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        fields.back() += c;
+        ++i;
+      } else if (c == '"') {
+        quoted = !quoted;
+      } else if (!quoted && c == ',') {
+        fields.emplace_back();
+      } else if (quoted || c != '\n') {
+        fields.back() += c;
+      }
+    }
+    if (fields.size() != 7) {
+      return false;
+    }
+    s.test = fields[0];
+    s.should = fields[1];
+    s.wall = std::chrono::nanoseconds{std::strtoll(fields[2].c_str(), {}, 10)};
+    s.cpu = std::chrono::nanoseconds{std::strtoll(fields[3].c_str(), {}, 10)};
+    s.max_rss_delta_kb = std::strtol(fields[4].c_str(), {}, 10);
+    s.allocations = std::strtoull(fields[5].c_str(), {}, 10);
+    s.allocated_bytes = std::strtoull(fields[6].c_str(), {}, 10);
+    return true;
+  }
+
+ private:
+  static std::string csv(const std::string& str) {
+    std::string result{"\""};
+    for (const auto c : str) {
+      result += c;
+      if (c == '"') {
+        result += c;
+      }
+    }
+    return result + '"';
+  }
+
+  static std::string json(const std::string& str) {
+    std::string result{"\""};
+    for (const auto c : str) {
+      if (c == '"' || c == '\\') {
+        result += '\\';
+        result += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        result += buffer;
+      } else {
+        result += c;
+      }
+    }
+    return result + '"';
+  }
+
+  std::string flag_{};
+  std::vector<section_stats> sections_{};
+  std::function<void(const std::string&)> forward_{};
+  mutable std::mutex mutex_{};
+};
+
+inline stats_report& stats() {
+  static stats_report report{is_flag_enabled("stats") ? flag("stats") : ""};
+  return report;
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
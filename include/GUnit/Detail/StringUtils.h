@@ -11,6 +11,7 @@
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace testing {
@@ -37,14 +38,45 @@ struct string {
   }
 };
 
-template <class TStr, std::size_t N, char... Chrs>
-struct make_string : make_string<TStr, N - 1, TStr().chrs[N - 1], Chrs...> {};
+template <class TStr, std::size_t... Ns>
+auto make_string_impl(std::index_sequence<Ns...>)
+    -> string<TStr().chrs[Ns]...>;
 
-template <class TStr, char... Chrs>
-struct make_string<TStr, 0, Chrs...> {
-  using type = string<Chrs...>;
+template <class TStr, std::size_t N>
+struct make_string {
+  using type =
+      decltype(make_string_impl<TStr>(std::make_index_sequence<N>{}));
 };
 
+#if defined(__cpp_nontype_template_args) && \
+    __cpp_nontype_template_args >= 201911L
+#define GUNIT_HAS_FIXED_STRING 1
+
+template <std::size_t N>
+struct fixed_string {
+  constexpr fixed_string(const char (&str)[N]) {  // NOLINT
+    for (auto i = 0u; i < N; ++i) {
+      chrs[i] = str[i];
+    }
+  }
+
+  char chrs[N]{};
+};
+
+template <fixed_string Str, std::size_t... Ns>
+auto make_fixed_string_impl(std::index_sequence<Ns...>)
+    -> string<Str.chrs[Ns]...>;
+
+/**
+ * Same as make_string<TStr, sizeof(str)>::type (including the trailing '\0')
+ */
+template <fixed_string Str>
+using make_string_t = decltype(make_fixed_string_impl<Str>(
+    std::make_index_sequence<sizeof(Str.chrs)>{}));
+#else
+#define GUNIT_HAS_FIXED_STRING 0
+#endif
+
 inline void trim(std::string &txt) {
   txt.erase(0, txt.find_first_not_of(" \n\r\t"));
   txt.erase(txt.find_last_not_of(" \n\r\t") + 1);
@@ -107,6 +139,13 @@ inline auto lexical_cast<bool>(const std::string &str) {
 
 }  // namespace detail
 
+#if GUNIT_HAS_FIXED_STRING
+template <detail::fixed_string Str>
+constexpr auto operator""_gtest_string() {
+  return decltype(detail::make_fixed_string_impl<Str>(
+      std::make_index_sequence<sizeof(Str.chrs) - 1>{})){};
+}
+#else
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wgnu-string-literal-operator-template"
 #elif defined(__GNUC__)
@@ -117,6 +156,7 @@ template <class T, T... Chrs>
 constexpr auto operator""_gtest_string() {
   return detail::string<Chrs...>{};
 }
+#endif
 
 }  // namespace v1
 }  // namespace testing
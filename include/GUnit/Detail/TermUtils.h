@@ -7,6 +7,20 @@
 //
 #pragma once
 
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <signal.h>
+#endif
+
 namespace testing {
 inline namespace v1 {
 namespace detail {
@@ -44,6 +58,83 @@ inline bool ShouldUseColor(bool stdout_is_tty) {
   // to be conservative.
 }
 
+/**
+ * Flushes stdout on a fatal signal, then lets the previous handler (or the
+ * default action) take over
+ *
+ * Best effort - `fflush` isn't async-signal-safe, but the process is going
+ * down anyway and the buffered progress shows where it crashed.
+ */
+inline bool flush_on_crash() {
+#if defined(__unix__) || defined(__APPLE__)
+  static constexpr int signals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+  static struct sigaction previous[sizeof(signals) / sizeof(*signals)]{};
+  struct sigaction action {};
+  action.sa_handler = [](int signal) {
+    std::fflush(stdout);
+    for (auto i = 0u; i < sizeof(signals) / sizeof(*signals); ++i) {
+      if (signals[i] == signal) {
+        ::sigaction(signal, &previous[i], nullptr);
+      }
+    }
+    ::raise(signal);
+  };
+  sigemptyset(&action.sa_mask);
+  for (auto i = 0u; i < sizeof(signals) / sizeof(*signals); ++i) {
+    ::sigaction(signals[i], &action, &previous[i]);
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Writes a progress line (SHOULD section, step, ...)
+ *
+ * Progress shares the stdout buffer with gtest's printer, which flushes it on
+ * test start/end and on failures, so the output stays in order. Otherwise the
+ * lines are flushed at least every second, on a crash (`flush_on_crash`) and
+ * on a timeout (`hang_watchdog`).
+ */
+inline void print_progress(const std::string& line) {
+  using clock = std::chrono::steady_clock;
+  static const auto crash = flush_on_crash();
+  static std::atomic<clock::rep> last_flush{
+      clock::now().time_since_epoch().count()};
+  (void)crash;
+
+  std::cout << line;
+  const auto now = clock::now().time_since_epoch();
+  auto last = last_flush.load(std::memory_order_relaxed);
+  if (now - clock::duration{last} >= std::chrono::seconds{1} &&
+      last_flush.compare_exchange_strong(last, now.count())) {
+    std::cout.flush();
+  }
+}
+
+/**
+ * Prints `[ TYPE     ]     name` progress line (yellow on a terminal, dimmed
+ * for DISABLED, STATS, ...)
+ */
+inline void print_progress(const std::string& type, const std::string& name,
+                           bool dim = false) {
+  static const bool is_stdout_tty = ShouldUseColor(
+      internal::posix::IsATTY(internal::posix::FileNo(stdout)) != 0);
+  const auto colorize = ShouldUseColor(is_stdout_tty);
+
+  std::ostringstream line{};
+  if (colorize) {
+    line << (dim ? "\33[0;33m\033[2m" : "\033[0;33m");
+  }
+  line << "[ " << std::left << std::setw(8) << type << " ] ";
+  if (colorize) {
+    line << "\033[m";  // Resets the terminal to default.
+  }
+  line << "    " << name << '\n';
+  print_progress(line.str());
+}
+
 }  // namespace detail
 }  // namespace v1
 }  // namespace testing
@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+inline std::string format_duration(std::chrono::nanoseconds ns) {
+  std::ostringstream str{};
+  str << std::fixed << std::setprecision(3);
+  if (ns < std::chrono::microseconds{1}) {
+    str << double(ns.count()) << " ns";
+  } else if (ns < std::chrono::milliseconds{1}) {
+    str << ns.count() / 1e3 << " us";
+  } else if (ns < std::chrono::seconds{1}) {
+    str << ns.count() / 1e6 << " ms";
+  } else {
+    str << ns.count() / 1e9 << " s";
+  }
+  return str.str();
+}
+
+/**
+ * Baseline p50 timings of `EXPECT_WITHIN` blocks (`<ns> <file:line>` lines)
+ *
+ * `--gunit_baseline=<file>` compares the blocks against the file (blocks which
+ * aren't there are added), failing if they are slower by more than
+ * `--gunit_baseline_tolerance=<percent>` (10 by default).
+ * `--gunit_baseline_update` overwrites the entries with the current timings.
+ */
+class baseline {
+ public:
+  explicit baseline(std::string file, double tolerance = 10.,
+                    bool update = false)
+      : file_{std::move(file)}, tolerance_{tolerance}, update_{update} {
+    entries_ = load();
+  }
+
+  bool is_enabled() const { return !file_.empty(); }
+  double tolerance() const { return tolerance_; }
+
+  /**
+   * @return baseline of the `key` (to compare with), zero if it has been
+   * just recorded
+   */
+  std::chrono::nanoseconds check(const std::string& key,
+                                 std::chrono::nanoseconds p50) {
+    if (!is_enabled()) {
+      return {};
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = entries_.find(key);
+    if (it != entries_.end() && !update_) {
+      return it->second;
+    }
+    entries_[key] = p50;
+    save(key, p50);
+    return {};
+  }
+
+ private:
+  /**
+   * Exclusive advisory lock of a file between processes (no-op without fork)
+   */
+  class file_lock {
+   public:
+    explicit file_lock(const std::string& file) {
+#if GUNIT_HAS_FORK
+      fd_ = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fd_ != -1) {
+        while (::flock(fd_, LOCK_EX) == -1 && errno == EINTR) {
+        }
+      }
+#else
+      (void)file;
+#endif
+    }
+    file_lock(const file_lock&) = delete;
+    file_lock& operator=(const file_lock&) = delete;
+    ~file_lock() {
+#if GUNIT_HAS_FORK
+      if (fd_ != -1) {
+        ::close(fd_);  // releases the lock
+      }
+#endif
+    }
+
+   private:
+    int fd_ = -1;
+  };
+
+  std::map<std::string, std::chrono::nanoseconds> load() const {
+    std::map<std::string, std::chrono::nanoseconds> entries{};
+    std::ifstream in{file_};
+    for (std::string line{}; std::getline(in, line);) {
+      const auto sep = line.find(' ');
+      if (sep != std::string::npos) {
+        entries[line.substr(sep + 1)] = std::chrono::nanoseconds{
+            std::strtoll(line.substr(0, sep).c_str(), nullptr, 10)};
+      }
+    }
+    return entries;
+  }
+
+  /**
+   * Merges with the file as it's now (other test processes might have
+   * updated it) while holding `<file>.lock`, so concurrent updates aren't lost
+   */
+  void save(const std::string& key, std::chrono::nanoseconds p50) const {
+    const file_lock lock{file_ + ".lock"};
+    auto entries = load();
+    entries[key] = p50;
+    const auto tmp = file_ + ".tmp";
+    {
+      std::ofstream out{tmp};
+      for (const auto& e : entries) {
+        out << e.second.count() << ' ' << e.first << '\n';
+      }
+      if (!out) {
+        std::remove(tmp.c_str());
+        return;
+      }
+    }
+    std::rename(tmp.c_str(), file_.c_str());
+  }
+
+  std::string file_{};
+  double tolerance_{};
+  bool update_{};
+  std::map<std::string, std::chrono::nanoseconds> entries_{};
+  std::mutex mutex_{};
+};
+
+inline baseline& baselines() {
+  static baseline b{[] {
+                      const auto f = flag("baseline");
+                      return f == "1" ? std::string{} : f;
+                    }(),
+                    flag("baseline_tolerance").empty()
+                        ? 10.
+                        : std::strtod(flag("baseline_tolerance").c_str(),
+                                      nullptr),
+                    is_flag_enabled("baseline_update")};
+  return b;
+}
+
+/**
+ * Times `samples` runs of a block and reports a failure if their median
+ * exceeds the `budget` (or regresses against the baseline)
+ *
+ * `for (within w{...}; w.next();) { block }`
+ */
+class within {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  template <class TRep, class TPeriod>
+  within(const char* file, int line,
+         std::chrono::duration<TRep, TPeriod> budget,
+         std::size_t samples = default_samples(),
+         TestPartResult::Type failure = TestPartResult::kNonFatalFailure)
+      : file_{file},
+        line_{line},
+        budget_{std::chrono::duration_cast<std::chrono::nanoseconds>(budget)},
+        samples_{std::max<std::size_t>(samples, 1)},
+        failure_{failure} {
+    times_.reserve(samples_);
+  }
+
+  /**
+   * @return true if the block has to be run again
+   */
+  bool next() {
+    const auto now = clock::now();
+    if (started_) {
+      times_.push_back(now - start_);
+    }
+    if (times_.size() == samples_) {
+      check();
+      return false;
+    }
+    started_ = true;
+    start_ = clock::now();
+    return true;
+  }
+
+  static std::size_t default_samples() {
+    const auto f = flag("within_samples");
+    return f.empty() ? 5 : std::strtoul(f.c_str(), nullptr, 10);
+  }
+
+ private:
+  void check() {
+    auto sorted = times_;
+    std::sort(sorted.begin(), sorted.end());
+    const auto p50 = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        sorted[(sorted.size() - 1) / 2]);
+    const auto summary =
+        "p50 " + format_duration(p50) + " (min " +
+        format_duration(sorted.front()) + ", max " +
+        format_duration(sorted.back()) + "; " +
+        std::to_string(sorted.size()) + " samples)";
+
+    if (p50 > budget_) {
+      fail("Expected to run within " + format_duration(budget_) +
+           "\n  Actual: " + summary);
+    }
+
+    auto& b = baselines();
+    const auto expected = b.check(
+        std::string{file_} + ':' + std::to_string(line_), p50);
+    if (expected.count() > 0 &&
+        p50.count() > expected.count() * (1. + b.tolerance() / 100.)) {
+      std::ostringstream str{};
+      str << std::fixed << std::setprecision(1)
+          << "Regressed by "
+          << (p50.count() - expected.count()) * 100. / expected.count()
+          << "% (tolerance " << b.tolerance()
+          << "%)\n  Baseline: p50 " << format_duration(expected)
+          << "\n  Actual: " << summary;
+      fail(str.str());
+    }
+  }
+
+  void fail(const std::string& message) const {
+    internal::AssertHelper(failure_, file_, line_, message.c_str()) =
+        Message();
+  }
+
+  const char* file_{};
+  int line_{};
+  std::chrono::nanoseconds budget_{};
+  std::size_t samples_{};
+  TestPartResult::Type failure_{};
+  std::vector<clock::duration> times_{};
+  bool started_{};
+  clock::time_point start_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
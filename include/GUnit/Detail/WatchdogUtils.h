@@ -0,0 +1,340 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "GUnit/Detail/ProcUtils.h"
+#include "GUnit/Detail/ProgUtils.h"
+
+// Feature detection: call stacks of the other threads (frame pointer walk)
+#if !defined(GUNIT_HAS_THREAD_STACKS)
+  #if GUNIT_HAS_BACKTRACE && defined(__linux__) && \
+      (defined(__x86_64__) || defined(__aarch64__))
+    #define GUNIT_HAS_THREAD_STACKS 1
+  #else
+    #define GUNIT_HAS_THREAD_STACKS 0
+  #endif
+#endif
+
+#if GUNIT_HAS_THREAD_STACKS
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+#if GUNIT_HAS_THREAD_STACKS
+/**
+ * Captures call stacks of the other threads of the process by interrupting
+ * them, one at a time, with SIGURG (ignored by default)
+ *
+ * `backtrace` isn't async-signal-safe (it might deadlock on the unwinder's
+ * lock held by the interrupted thread), so the handler follows the frame
+ * pointers instead, reading them with `process_vm_readv`, which fails rather
+ * than faults on a bad one. Code built without frame pointers shows only
+ * the frame it has been interrupted in (and the ones of its callers which
+ * keep them).
+ */
+class thread_stacks {
+  static constexpr auto MAX_CALL_STACK_SIZE = 64;
+
+ public:
+  /**
+   * @return `Thread <tid> (<name>):` followed by the call stack of every
+   * thread but the calling one
+   */
+  static std::string dump(const std::string& newline, int stack_size) {
+    static std::mutex mutex{};
+    const std::lock_guard<std::mutex> lock{mutex};
+
+    struct sigaction action {}, previous{};
+    action.sa_sigaction = &capture;
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    if (::sigaction(SIGURG, &action, &previous)) {
+      return {};
+    }
+
+    std::string result{};
+    const auto self = pid_t(::syscall(SYS_gettid));
+    const auto dir = ::opendir("/proc/self/task");
+    for (auto entry = dir ? ::readdir(dir) : nullptr; entry;
+         entry = ::readdir(dir)) {
+      const auto tid = pid_t(std::atoi(entry->d_name));
+      if (tid <= 0 || tid == self) {
+        continue;
+      }
+      state().frames = 0;
+      state().done = false;
+      if (::syscall(SYS_tgkill, ::getpid(), tid, SIGURG)) {
+        continue;
+      }
+      for (auto i = 0; i < 100 && !state().done; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      result += newline + "Thread " + std::to_string(tid) + " (" + name(tid) +
+                "):" + newline + "  ";
+      result += state().done
+                    ? call_stack(state().bt, state().frames, newline + "  ",
+                                 0, stack_size)
+                    : "not responding";
+    }
+    if (dir) {
+      ::closedir(dir);
+    }
+    ::sigaction(SIGURG, &previous, nullptr);
+    return result;
+  }
+
+ private:
+  struct capture_state {
+    void* bt[MAX_CALL_STACK_SIZE]{};
+    int frames{};
+    std::atomic<bool> done{};
+  };
+
+  static capture_state& state() {
+    static capture_state s{};
+    return s;
+  }
+
+  static void capture(int, siginfo_t*, void* context) {
+    auto& s = state();
+    if (s.done) {
+      return;
+    }
+    const auto& registers = static_cast<ucontext_t*>(context)->uc_mcontext;
+#if defined(__x86_64__)
+    const auto pc = std::uintptr_t(registers.gregs[REG_RIP]);
+    auto fp = std::uintptr_t(registers.gregs[REG_RBP]);
+#else
+    const auto pc = std::uintptr_t(registers.pc);
+    auto fp = std::uintptr_t(registers.regs[29]);
+#endif
+    s.bt[s.frames++] = reinterpret_cast<void*>(pc);
+    std::uintptr_t frame[2]{};  // caller's frame pointer, return address
+    while (s.frames < MAX_CALL_STACK_SIZE && read(fp, frame) && frame[1] &&
+           frame[0] > fp) {
+      s.bt[s.frames++] = reinterpret_cast<void*>(frame[1]);
+      fp = frame[0];
+    }
+    s.done = true;
+  }
+
+  static bool read(std::uintptr_t address, std::uintptr_t (&frame)[2]) {
+    iovec local{frame, sizeof(frame)};
+    iovec remote{reinterpret_cast<void*>(address), sizeof(frame)};
+    return address && ::process_vm_readv(::getpid(), &local, 1, &remote, 1,
+                                         0) == ssize_t(sizeof(frame));
+  }
+
+  static std::string name(pid_t tid) {
+    std::ifstream comm{"/proc/self/task/" + std::to_string(tid) + "/comm"};
+    std::string name{};
+    std::getline(comm, name);
+    return name;
+  }
+};
+#endif
+
+/**
+ * Fails tests which haven't finished in time
+ *
+ * Every armed `guard` has a deadline. When it expires, the watchdog thread
+ * reports a failure with the description of the guard (test, section,
+ * outstanding expectations) and the call stacks of all threads, then calls
+ * `on_timeout`. A hung thread can't be stopped, so by default a forked child
+ * or a `--gunit_jobs` worker exits and its parent carries on with the
+ * following tests (see `fail`).
+ */
+class hang_watchdog {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  class guard {
+   public:
+    guard(hang_watchdog& watchdog, std::uint64_t id)
+        : watchdog_{watchdog}, id_{id} {}
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+    ~guard() { watchdog_.disarm(id_); }
+
+   private:
+    hang_watchdog& watchdog_;
+    std::uint64_t id_{};
+  };
+
+  explicit hang_watchdog(
+      std::function<void(const std::string&)> on_timeout = &fail)
+      : on_timeout_{std::move(on_timeout)} {}
+  hang_watchdog(const hang_watchdog&) = delete;
+  hang_watchdog& operator=(const hang_watchdog&) = delete;
+
+  ~hang_watchdog() {
+    if (!owner()) {
+      (void)thread_.release();  // of the parent process
+      return;
+    }
+    {
+      const std::lock_guard<std::mutex> lock{mutex_};
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_) {
+      thread_->join();
+    }
+  }
+
+  /**
+   * @param describe appended to the failure, called by the watchdog thread
+   * while the guarded code might still be running
+   */
+  std::unique_ptr<guard> arm(std::chrono::milliseconds timeout,
+                             std::function<std::string()> describe) {
+    if (!owner()) {  // forked, only the calling thread has been copied
+      (void)thread_.release();
+      new (&mutex_) std::mutex{};  // might have been locked by the watchdog
+      new (&cv_) std::condition_variable{};
+#if GUNIT_HAS_FORK
+      pid_ = 0;
+#endif
+    }
+    std::uint64_t id{};
+    {
+      const std::lock_guard<std::mutex> lock{mutex_};
+      id = ++ids_;
+      guards_[id] = {clock::now() + timeout, timeout, std::move(describe)};
+      if (!thread_) {
+#if GUNIT_HAS_FORK
+        pid_ = ::getpid();
+#endif
+        thread_ = std::make_unique<std::thread>([this] { watch(); });
+      }
+    }
+    cv_.notify_all();
+    return std::make_unique<guard>(*this, id);
+  }
+
+  /**
+   * Reports the failure, then a forked child (`--gunit_fork`, `--gunit_jobs`)
+   * exits, so that its parent carries on. The main process goes on waiting
+   * for the hung test.
+   */
+  static void fail(const std::string& message) {
+    report_failure(message);
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    if (forward_results::is_installed()) {  // results go to the parent
+      std::_Exit(1);
+    }
+  }
+
+ private:
+  struct entry {
+    clock::time_point deadline{};
+    std::chrono::milliseconds timeout{};
+    std::function<std::string()> describe{};
+  };
+
+  void disarm(std::uint64_t id) {
+    const std::lock_guard<std::mutex> lock{mutex_};
+    guards_.erase(id);  // the watchdog wakes up at the old deadline at worst
+  }
+
+  bool owner() const {
+#if GUNIT_HAS_FORK
+    const auto pid = pid_.load();
+    return !pid || pid == ::getpid();
+#else
+    return true;
+#endif
+  }
+
+  void watch() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (!stopped_) {
+      if (guards_.empty()) {
+        cv_.wait(lock);
+        continue;
+      }
+      auto expired = guards_.begin();
+      for (auto it = guards_.begin(); it != guards_.end(); ++it) {
+        if (it->second.deadline < expired->second.deadline) {
+          expired = it;
+        }
+      }
+      if (clock::now() < expired->second.deadline) {
+        cv_.wait_until(lock, expired->second.deadline);
+        continue;
+      }
+      const auto e = std::move(expired->second);
+      guards_.erase(expired);
+      lock.unlock();
+      on_timeout_(message(e));
+      lock.lock();
+    }
+  }
+
+  static std::string message(const entry& e) {
+    auto result = "Timeout of " + std::to_string(e.timeout.count()) +
+                  " ms exceeded" + (e.describe ? e.describe() : "");
+#if GUNIT_HAS_THREAD_STACKS
+    result += "\nThreads:" + thread_stacks::dump("\n  ", 32);
+#endif
+    return result;
+  }
+
+  std::function<void(const std::string&)> on_timeout_{};
+  std::mutex mutex_{};
+  std::condition_variable cv_{};
+  std::map<std::uint64_t, entry> guards_{};
+  std::uint64_t ids_{};
+  bool stopped_{};
+  std::unique_ptr<std::thread> thread_{};
+#if GUNIT_HAS_FORK
+  std::atomic<pid_t> pid_{};
+#endif
+};
+
+/**
+ * `--gunit_timeout=ms` (GUNIT_TIMEOUT=ms) fails GTESTs and SHOULD sections
+ * running longer than `ms` (disabled by default)
+ */
+inline hang_watchdog& watchdog() {
+  static const auto w = new hang_watchdog{};  // never destroyed, the watchdog
+                                              // thread might be reporting
+  return *w;
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
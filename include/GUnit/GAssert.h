@@ -9,178 +9,528 @@
 
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
-#include "GUnit/Detail/StringUtils.h"
+#include "GUnit/Detail/AllocUtils.h"
+#include "GUnit/Detail/RangeUtils.h"
+#include "GUnit/Detail/TimeUtils.h"
 
 namespace testing {
 inline namespace v1 {
 namespace detail {
 
+/**
+ * Stringified assertion expression with the operands of its top level
+ * comparisons (outside of parentheses, brackets, braces and literals), split
+ * at compile time
+ *
+ * An expression is decomposable when it is at most one comparison of operands
+ * binding tighter than `<<`, so `op << lhs == rhs` captures both of them.
+ * Logical, bitwise, conditional, shift and assignment operators (or chained
+ * comparisons) are evaluated as a whole instead.
+ */
+class expression {
+ public:
+  enum comparison : std::size_t { EQ, NE, LT, LE, GT, GE, COMPARISONS };
+
+  constexpr explicit expression(const char* str) : str_{str} {
+    while (str_[size_]) {
+      ++size_;
+    }
+    for (auto& pos : pos_) {
+      pos = size_;
+    }
+    parse();
+  }
+
+  constexpr const char* c_str() const { return str_; }
+
+  constexpr bool decomposable() const { return !complex_ && comparisons_ < 2; }
+
+  static constexpr const char* op(comparison c) {
+    constexpr const char* ops[] = {"==", "!=", "<", "<=", ">", ">="};
+    return ops[c];
+  }
+
+  /**
+   * @return lhs of the first top level `c` comparison, the whole expression
+   * if there is none
+   */
+  constexpr std::string_view lhs(comparison c) const {
+    return trim({str_, pos_[c]});
+  }
+
+  /**
+   * @return rhs of the first top level `c` comparison, empty if there is none
+   */
+  constexpr std::string_view rhs(comparison c) const {
+    const auto begin = pos_[c] == size_ ? size_ : pos_[c] + length(op(c));
+    return trim({str_ + begin, size_ - begin});
+  }
+
+ private:
+  static constexpr std::size_t length(const char* str) {
+    std::size_t size{};
+    while (str[size]) {
+      ++size;
+    }
+    return size;
+  }
+
+  static constexpr bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  static constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  static constexpr bool is_identifier(char c) {
+    return is_digit(c) || c == '_' || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z');
+  }
+
+  static constexpr std::string_view trim(std::string_view str) {
+    while (!str.empty() && is_space(str.front())) {
+      str.remove_prefix(1);
+    }
+    while (!str.empty() && is_space(str.back())) {
+      str.remove_suffix(1);
+    }
+    return str;
+  }
+
+  constexpr char at(std::size_t i) const { return i < size_ ? str_[i] : 0; }
+
+  constexpr void found(comparison c, std::size_t i) {
+    if (pos_[c] == size_) {
+      pos_[c] = i;
+    }
+    ++comparisons_;
+  }
+
+  /**
+   * @return whether `'` at `i` is a digit separator (`1'000`, `0xff'ff`)
+   */
+  constexpr bool is_separator(std::size_t i) const {
+    auto begin = i;
+    while (begin && (is_identifier(str_[begin - 1]) || str_[begin - 1] == '.' ||
+                     str_[begin - 1] == '\'')) {
+      --begin;
+    }
+    return begin != i && is_digit(str_[begin]) && is_identifier(at(i + 1));
+  }
+
+  /**
+   * @return index of `>` closing a template argument list opened at `i`
+   * (`static_cast<int>(x)`, `limits<T>::max()`), zero if `<` is a comparison
+   */
+  constexpr std::size_t template_end(std::size_t i) const {
+    if (!i || !is_identifier(str_[i - 1]) || is_space(at(i + 1))) {
+      return {};
+    }
+    auto depth = 0;
+    for (auto j = i; j < size_; ++j) {
+      const auto c = str_[j];
+      if (c == '<' || c == '(' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == ']' || c == '}') {
+        if (--depth < 1) {
+          return {};
+        }
+      } else if (c == '>' && str_[j - 1] != '-' && !--depth) {
+        return is_space(str_[j - 1]) ? 0 : j;
+      } else if ((c == '&' || c == '|') && at(j + 1) == c) {
+        return {};  // `a<b && c>d`
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @return length of the identifier at `i`, marks the expression complex if
+   * it's an alternative token of a logical or bitwise operator
+   */
+  constexpr std::size_t identifier(std::size_t i) {
+    auto size = std::size_t{};
+    while (is_identifier(at(i + size))) {
+      ++size;
+    }
+    const std::string_view id{str_ + i, size};
+    for (const auto token : {"and", "or", "xor", "bitand", "bitor", "not_eq",
+                             "and_eq", "or_eq", "xor_eq"}) {
+      complex_ = complex_ || id == token;
+    }
+    return size;
+  }
+
+  constexpr void parse() {
+    auto depth = 0;
+    for (std::size_t i{}; i < size_; ++i) {
+      const auto c = str_[i];
+      if (c == '\'' && is_separator(i)) {
+        continue;
+      } else if (c == '"' || c == '\'') {  // literal, skipped with its escapes
+        for (++i; i < size_ && str_[i] != c; ++i) {
+          i += str_[i] == '\\';
+        }
+      } else if (c == '(' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == ']' || c == '}') {
+        --depth;
+      } else if (depth) {
+        continue;
+      } else if (is_identifier(c)) {  // numbers aren't alternative tokens
+        i += (is_digit(c) ? 1 : identifier(i)) - 1;
+      } else if (c == '=' && at(i + 1) == '=') {
+        found(EQ, i++);
+      } else if (c == '!' && at(i + 1) == '=') {
+        found(NE, i++);
+      } else if ((c == '<' || c == '>') && at(i + 1) == c) {
+        complex_ = true;
+        i += 1 + (at(i + 2) == '=');  // shift (assignment)
+      } else if (c == '<' && at(i + 1) == '=' && at(i + 2) == '>') {
+        complex_ = true;
+        i += 2;  // three-way comparison
+      } else if (c == '<' && template_end(i)) {
+        i = template_end(i);
+      } else if (c == '<') {
+        at(i + 1) == '=' ? found(LE, i++) : found(LT, i);
+      } else if (c == '>' && (!i || str_[i - 1] != '-')) {  // not ->
+        at(i + 1) == '=' ? found(GE, i++) : found(GT, i);
+      } else if (c == '&' || c == '|' || c == '^' || c == '?' || c == '=') {
+        complex_ = true;  // binds looser than a comparison
+      }
+    }
+  }
+
+  const char* str_{};
+  std::size_t size_{};
+  std::size_t pos_[COMPARISONS]{};
+  std::size_t comparisons_{};
+  bool complex_{};
+};
+
+template <class TCompare>
+constexpr auto comparison_of = expression::EQ;  // std::equal_to, almost_equal
+template <>
+constexpr auto comparison_of<std::not_equal_to<>> = expression::NE;
+template <>
+constexpr auto comparison_of<std::less<>> = expression::LT;
+template <>
+constexpr auto comparison_of<std::less_equal<>> = expression::LE;
+template <>
+constexpr auto comparison_of<std::greater<>> = expression::GT;
+template <>
+constexpr auto comparison_of<std::greater_equal<>> = expression::GE;
+
 struct info {
   const char* file{};
   unsigned long line{};
-  std::string expr{};
+  const expression* expr{};
   TestPartResult::Type failure{};
 };
 
-template <class TShouldError, class TLhs, class TRhs,
-          AssertionResult (*Comp)(const char*, const char*, TLhs, TRhs)>
-class msg : public decltype(Message()) {
+/**
+ * Message streamed to an assertion (`EXPECT(...) << "message"`)
+ *
+ * `Message` allocates its stream when it's constructed, so it's only created
+ * for failed assertions, values streamed to the passed ones are dropped.
+ */
+class lazy_message {
+ public:
+  template <class T>
+  const lazy_message& operator<<(const T& value) const {
+    if (!passed_) {
+      get() << value;
+    }
+    return *this;
+  }
+
+  const lazy_message& operator<<(std::ostream& (*manip)(std::ostream&)) const {
+    if (!passed_) {
+      get() << manip;
+    }
+    return *this;
+  }
+
+ protected:
+  void passed(bool passed) { passed_ = passed; }
+
+  void report(const info& info, const char* failure) const {
+    internal::AssertHelper(info.failure, info.file, info.line, failure) =
+        message_ ? *message_ : Message{};
+  }
+
+ private:
+  Message& get() const {
+    if (!message_) {
+      message_ = std::make_unique<Message>();
+    }
+    return *message_;
+  }
+
+  bool passed_{};
+  mutable std::unique_ptr<Message> message_{};
+};
+
+/**
+ * Floating point equality within 4 ULPs (`EXPECT_DOUBLE_EQ`), in the type of
+ * the lhs (`EXPECT_FLOAT_EQ` for a float one), the rhs is converted to it
+ */
+struct almost_equal {
+  template <class TLhs, class TRhs>
+  using type = std::conditional_t<std::is_floating_point<TLhs>::value, TLhs,
+                                  TRhs>;
+
+  template <class TLhs, class TRhs>
+  bool operator()(const TLhs& lhs, const TRhs& rhs) const {
+    using T = type<TLhs, TRhs>;
+    return internal::FloatingPoint<T>{T(lhs)}.AlmostEquals(
+        internal::FloatingPoint<T>{T(rhs)});
+  }
+};
+
+/**
+ * Compares the values once, when it's constructed, the failure message is
+ * formatted from the cached result (the same one as of gtest's `CmpHelper`s)
+ */
+template <class TShouldError, class TLhs, class TRhs, class TCompare>
+class msg : public lazy_message {
+  static constexpr auto comparison = comparison_of<TCompare>;
+
  public:
-  msg(const info& info, const std::string& comp, TLhs lhs, TRhs rhs)
+  msg(const info& info, TLhs lhs, TRhs rhs)
       : info_{info},
-        comp_{comp},
         lhs_{lhs},
         rhs_{rhs},
-        result_{Comp("", "", lhs_, rhs_)} {}
+        result_{bool(TCompare{}(lhs_, rhs_))} {
+    passed(result_);
+  }
   ~msg() {
-    if (TShouldError::value) {
-      const auto begin = info_.expr.find(comp_);
-      auto lhs_expr = info_.expr.substr(0, begin);
-      trim(lhs_expr);
-      auto rhs_expr = info_.expr.substr(begin + comp_.size());
-      trim(rhs_expr);
-      const AssertionResult gtest_ar =
-          (Comp(lhs_expr.c_str(), rhs_expr.c_str(), lhs_, rhs_));
-      if (!gtest_ar) {
-        internal::AssertHelper(info_.failure, info_.file, info_.line,
-                               gtest_ar.failure_message()) = *this;
-      }
+    if (TShouldError::value && !result_) {  // operands split at compile time
+      const std::string lhs_expr{info_.expr->lhs(comparison)};
+      const std::string rhs_expr{info_.expr->rhs(comparison)};
+      report(info_,
+             failure(lhs_expr.c_str(), rhs_expr.c_str()).failure_message());
     }
   }
 
   operator bool() const { return result_; }
 
  private:
+  AssertionResult failure(const char* lhs_expr, const char* rhs_expr) const {
+    if constexpr (std::is_same<TCompare, almost_equal>::value) {
+      using type = almost_equal::type<std::decay_t<TLhs>, std::decay_t<TRhs>>;
+      std::stringstream lhs{}, rhs{};
+      lhs << std::setprecision(std::numeric_limits<type>::digits10 + 2)
+          << type(lhs_);
+      rhs << std::setprecision(std::numeric_limits<type>::digits10 + 2)
+          << type(rhs_);
+      return internal::EqFailure(lhs_expr, rhs_expr, lhs.str(), rhs.str(),
+                                 false);
+    } else if constexpr (std::is_same<TCompare, std::equal_to<>>::value) {
+      return internal::CmpHelperEQFailure(lhs_expr, rhs_expr, lhs_, rhs_);
+    } else {
+      return internal::CmpHelperOpFailure(lhs_expr, rhs_expr, lhs_, rhs_,
+                                          expression::op(comparison));
+    }
+  }
+
   info info_{};
-  std::string comp_{};
   TLhs lhs_;
   TRhs rhs_;
   bool result_{false};
 };
 
+/**
+ * Value of an assertion without a comparison, converted to bool once
+ */
 template <class TShouldError>
-class op {
-  template <class TLhs>
-  class comp : public decltype(Message()) {
-   public:
-    explicit comp(const info& info, const TLhs& lhs) : info_{info}, lhs_{lhs} {
-      set_result(lhs_);
+class comp : public lazy_message {
+ public:
+  template <class T>
+  comp(const info& info, const T& value) : info_{info} {
+    set_result(value);
+    passed(result_);
+  }
+
+  ~comp() {
+    if (TShouldError::value && checked_ && !result_) {
+      report(info_,
+             internal::CmpHelperEQFailure(info_.expr->c_str(), "true", false,
+                                          true)
+                 .failure_message());
     }
+  }
 
-    ~comp() { assert_error(lhs_); }
+  operator bool() const { return result_; }
 
-    template <class TRhs,
-              std::enable_if_t<std::is_floating_point<TLhs>::value ||
-                                   std::is_floating_point<TRhs>::value,
-                               int> = 0>
-    auto operator==(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, TLhs, TRhs,
-                 internal::CmpHelperFloatingPointEQ<TLhs>>{info_, "==", lhs_,
-                                                           rhs};
-    }
+ private:
+  template <class T>
+  std::enable_if_t<std::is_constructible<bool, T>::value> set_result(
+      const T& t) {
+    result_ = bool(t);
+    checked_ = true;
+  }
 
-    template <class TRhs,
-              std::enable_if_t<!std::is_floating_point<TLhs>::value &&
-                                   !std::is_floating_point<TRhs>::value,
-                               int> = 0>
-    auto operator==(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperEQ>{
-          info_, "==", lhs_, rhs};
-    }
+  template <class T>
+  std::enable_if_t<!std::is_constructible<bool, T>::value> set_result(
+      const T&) {}
 
-    template <class TRhs>
-    auto operator!=(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperNE>{
-          info_, "!=", lhs_, rhs};
-    }
+  info info_{};
+  bool checked_{false};
+  bool result_{false};
+};
 
-    template <class TRhs>
-    auto operator>(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperGT>{
-          info_, ">", lhs_, rhs};
-    }
+/**
+ * Operands of a decomposed comparison (`lhs == rhs`), compared by `msg`
+ */
+template <class TLhs, class TRhs, class TCompare>
+struct operands {
+  operator bool() const { return TCompare{}(lhs, rhs); }  // not decomposed
 
-    template <class TRhs>
-    auto operator>=(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperGE>{
-          info_, ">=", lhs_, rhs};
-    }
+  TLhs lhs;
+  TRhs rhs;
+};
 
-    template <class TRhs>
-    auto operator<=(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperLE>{
-          info_, "<=", lhs_, rhs};
-    }
+/**
+ * Whether the comparison of decomposed operands (see `decomposer`) compiles,
+ * e.g. `(a <=> b) < 0` doesn't, 0 is no longer a literal once captured
+ */
+template <class T>
+struct is_comparable : std::true_type {};
+
+template <class TLhs, class TRhs, class TCompare>
+struct is_comparable<operands<TLhs, TRhs, TCompare>>
+    : std::is_invocable<TCompare, const std::decay_t<TLhs>&,
+                        const std::decay_t<TRhs>&> {};
+
+/**
+ * Char arrays (string literals) are compared by value, unless with a pointer
+ */
+template <class T, class TOther>
+using compared_t = std::conditional_t<
+    std::is_array<std::remove_reference_t<T>>::value &&
+        std::is_same<std::remove_cv_t<std::remove_extent_t<
+                         std::remove_reference_t<T>>>,
+                     char>::value &&
+        !std::is_pointer<std::remove_reference_t<TOther>>::value &&
+        !std::is_null_pointer<std::remove_cv_t<
+            std::remove_reference_t<TOther>>>::value,
+    std::string_view, T>;
+
+/**
+ * Lhs of a decomposed expression, `operand << lhs == rhs`
+ */
+template <class TLhs>
+struct operand {
+  static constexpr auto is_floating_point =
+      std::is_floating_point<std::decay_t<TLhs>>::value;
+
+  template <class TRhs,
+            std::enable_if_t<is_floating_point ||
+                                 std::is_floating_point<TRhs>::value,
+                             int> = 0>
+  auto operator==(const TRhs& rhs) const {
+    return operands<std::decay_t<TLhs>, TRhs, almost_equal>{value, rhs};
+  }
 
-    template <class TRhs>
-    auto operator<(const TRhs& rhs) const {
-      followed_ = true;
-      return msg<TShouldError, const TLhs&, const TRhs&, internal::CmpHelperLT>{
-          info_, "<", lhs_, rhs};
-    }
+  template <class TRhs,
+            std::enable_if_t<!is_floating_point &&
+                                 !std::is_floating_point<TRhs>::value,
+                             int> = 0>
+  auto operator==(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::equal_to<>>{value, rhs};
+  }
 
-    operator bool() const { return result_; }
+  template <class TRhs>
+  auto operator!=(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::not_equal_to<>>{value, rhs};
+  }
 
-   private:
-    void set_result(const bool& result) {
-      result_ = internal::CmpHelperEQ("", "", result, true);
-    }
+  template <class TRhs>
+  auto operator>(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::greater<>>{value, rhs};
+  }
 
-    template <class T>
-    std::enable_if_t<std::is_constructible<bool, T>::value> set_result(
-        const T& t) {
-      set_result(bool(t));
-    }
+  template <class TRhs>
+  auto operator>=(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::greater_equal<>>{value, rhs};
+  }
 
-    template <class T>
-    std::enable_if_t<!std::is_constructible<bool, T>::value> set_result(
-        const T&) {}
+  template <class TRhs>
+  auto operator<=(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::less_equal<>>{value, rhs};
+  }
 
-    void assert_error(const bool& result) {
-      if (TShouldError::value && !followed_) {
-        const AssertionResult gtest_ar =
-            (internal::CmpHelperEQ(info_.expr.c_str(), "true", result, true));
-        if (!gtest_ar) {
-          internal::AssertHelper(info_.failure, info_.file, info_.line,
-                                 gtest_ar.failure_message()) = *this;
-        }
-      }
-    }
+  template <class TRhs>
+  auto operator<(const TRhs& rhs) const {
+    return operands<compared_t<TLhs, TRhs>, compared_t<const TRhs&, TLhs>,
+                    std::less<>>{value, rhs};
+  }
 
-    template <class T>
-    std::enable_if_t<std::is_constructible<bool, T>::value> assert_error(
-        const T& t) {
-      assert_error(bool(t));
-    }
+  TLhs value;
+};
 
-    template <class T>
-    std::enable_if_t<!std::is_constructible<bool, T>::value> assert_error(
-        const T&) {}
+/**
+ * Captures the lhs of a decomposable expression (see `expression`), passes
+ * the lhs of other ones through, so that they are evaluated as they are
+ */
+template <bool Decomposable>
+struct decomposer {
+  template <class TLhs>
+  operand<const TLhs&> operator<<(const TLhs& lhs) const {
+    return {lhs};
+  }
+};
 
-    info info_{};
-    TLhs lhs_{};
-    mutable bool followed_{false};
-    bool result_{false};
-  };
+template <>
+struct decomposer<false> {
+  template <class TLhs>
+  TLhs&& operator<<(TLhs&& lhs) const {
+    return std::forward<TLhs>(lhs);
+  }
+};
 
+/**
+ * Assertion of the value of an expression,
+ * `op{info} = decomposer<...>{} << expression`
+ *
+ * Assignment binds looser than any operator of the expression, so the result
+ * is either a decomposed comparison, a decomposed operand or a plain value.
+ */
+template <class TShouldError>
+class op {
  public:
   explicit op(const info& info) : info_{info} {}
 
+  template <class TLhs, class TRhs, class TCompare>
+  msg<TShouldError, TLhs, TRhs, TCompare> operator=(
+      const operands<TLhs, TRhs, TCompare>& c) const {
+    return {info_, c.lhs, c.rhs};
+  }
+
   template <class TLhs>
-  comp<TLhs> operator<<(const TLhs& lhs) const {
-    return comp<TLhs>{info_, lhs};
+  comp<TShouldError> operator=(const operand<TLhs>& lhs) const {
+    return {info_, lhs.value};
   }
 
-  comp<std::string> operator<<(const char* lhs) const {
-    return comp<std::string>{info_, std::string{lhs}};
+  template <class T>
+  comp<TShouldError> operator=(const T& value) const {
+    return {info_, value};
   }
 
  private:
@@ -209,29 +559,80 @@ void prevent_commas(T&&) {}
 #define GUNIT_PREVENT_COMMAS(...) \
   decltype(::testing::detail::prevent_commas(__VA_ARGS__))()
 
+#define GUNIT_EXPRESSION(...)                                            \
+  [] {                                                                   \
+    static constexpr ::testing::detail::expression expr{#__VA_ARGS__}; \
+    return &expr;                                                        \
+  }()
+
+#if defined(__clang__)  // `op << lhs == rhs` is the intended precedence
+#pragma clang diagnostic ignored "-Woverloaded-shift-op-parentheses"
+#endif
+
+#define GUNIT_DECOMPOSER(...)                                             \
+  ::testing::detail::decomposer<                                          \
+      ::testing::detail::expression{#__VA_ARGS__}.decomposable() &&       \
+      ::testing::detail::is_comparable<decltype(                          \
+          ::testing::detail::decomposer<::testing::detail::expression{    \
+              #__VA_ARGS__}.decomposable()>{} << __VA_ARGS__)>::value>{}
+
 #define EXPECT_IMPL(...)                                                     \
-  (::testing::detail::op<std::true_type>{                                    \
-       ::testing::detail::info{__FILE__, __LINE__, #__VA_ARGS__,             \
-                               ::testing::TestPartResult::kNonFatalFailure}} \
-   << (__VA_ARGS__))
+  (::testing::detail::op<std::true_type>{::testing::detail::info{            \
+       __FILE__, __LINE__, GUNIT_EXPRESSION(__VA_ARGS__),                    \
+       ::testing::TestPartResult::kNonFatalFailure}} =                       \
+       GUNIT_DECOMPOSER(__VA_ARGS__) << __VA_ARGS__)
 
 #define EXPECT(...)                  \
   GUNIT_PREVENT_COMMAS(__VA_ARGS__); \
   EXPECT_IMPL(__VA_ARGS__)
 
 #define ASSERT_IMPL(...)                                                     \
-  if (::testing::detail::op<std::false_type>{                                \
-          ::testing::detail::info{__FILE__, __LINE__, #__VA_ARGS__,          \
-                                  ::testing::TestPartResult::kFatalFailure}} \
-      << (__VA_ARGS__))                                                      \
+  if (const auto& gunit_assert =                                             \
+          (::testing::detail::op<std::true_type>{::testing::detail::info{    \
+               __FILE__, __LINE__, GUNIT_EXPRESSION(__VA_ARGS__),            \
+               ::testing::TestPartResult::kFatalFailure}} =                  \
+               GUNIT_DECOMPOSER(__VA_ARGS__) << __VA_ARGS__))                \
     void(::testing::detail::drop{});                                         \
   else                                                                       \
-    return ::testing::detail::ret_void{} ==                                  \
-           (::testing::detail::op<std::true_type>{::testing::detail::info{   \
-                __FILE__, __LINE__, #__VA_ARGS__,                            \
-                ::testing::TestPartResult::kFatalFailure}}                   \
-            << (__VA_ARGS__))
+    return ::testing::detail::ret_void{} == gunit_assert
 
 #define ASSERT(...)                  \
   GUNIT_PREVENT_COMMAS(__VA_ARGS__); \
   ASSERT_IMPL(__VA_ARGS__)
+
+/**
+ * Runs the following block a few times and fails if its median time exceeds
+ * the budget, `EXPECT_WITHIN(budget[, samples]) { ... }`
+ */
+#define EXPECT_WITHIN(...)                                        \
+  for (::testing::detail::within gunit_within{__FILE__, __LINE__, \
+                                              __VA_ARGS__};       \
+       gunit_within.next();)
+
+/**
+ * Fails if the following block allocates more than `n` times (requires linking
+ * with `gunit_alloc`), `EXPECT_ALLOCATIONS_AT_MOST(n) { ... }`
+ */
+#define EXPECT_ALLOCATIONS_AT_MOST(n)                                    \
+  for (::testing::detail::allocations_at_most gunit_allocs{__FILE__,     \
+                                                           __LINE__, n}; \
+       gunit_allocs.next();)
+
+#define EXPECT_NO_ALLOCATIONS EXPECT_ALLOCATIONS_AT_MOST(0)
+
+/**
+ * Compares whole ranges at once (vectorized for contiguous integers) and
+ * reports the first mismatching index with its neighbourhood,
+ * `EXPECT_RANGE_EQ(actual, expected)`, `EXPECT_BYTES_EQ(lhs, rhs, size)`
+ */
+#define EXPECT_RANGE_EQ(actual, expected) \
+  EXPECT_PRED_FORMAT2(::testing::detail::range_eq, actual, expected)
+
+#define ASSERT_RANGE_EQ(actual, expected) \
+  ASSERT_PRED_FORMAT2(::testing::detail::range_eq, actual, expected)
+
+#define EXPECT_BYTES_EQ(lhs, rhs, size) \
+  EXPECT_PRED_FORMAT3(::testing::detail::bytes_eq, lhs, rhs, size)
+
+#define ASSERT_BYTES_EQ(lhs, rhs, size) \
+  ASSERT_PRED_FORMAT3(::testing::detail::bytes_eq, lhs, rhs, size)
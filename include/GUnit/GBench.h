@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+#include "GUnit/Detail/TermUtils.h"
+#include "GUnit/GTest.h"
+
+namespace testing {
+inline namespace v1 {
+
+/**
+ * Prevents the compiler from optimizing away the computation of `value`
+ */
+template <class T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink{};
+  sink = &value;
+#endif
+}
+
+namespace detail {
+
+struct bench_result {
+  std::size_t iterations{};  // per sample
+  std::size_t samples{};
+  double mean{};  // ns/op
+  double stddev{};
+  double min{};
+  double p50{};
+  double p90{};
+  double p99{};
+};
+
+/**
+ * @param ns_per_op ns/op of every sample
+ */
+inline bench_result make_bench_result(std::vector<double> ns_per_op,
+                                      std::size_t iterations) {
+  bench_result result{iterations, ns_per_op.size()};
+  if (ns_per_op.empty()) {
+    return result;
+  }
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+  const auto percentile = [&ns_per_op](double p) {
+    const auto rank = std::size_t(std::ceil(p * ns_per_op.size()));
+    return ns_per_op[std::max<std::size_t>(rank, 1) - 1];
+  };
+  for (const auto ns : ns_per_op) {
+    result.mean += ns;
+  }
+  result.mean /= ns_per_op.size();
+  for (const auto ns : ns_per_op) {
+    result.stddev += (ns - result.mean) * (ns - result.mean);
+  }
+  result.stddev = ns_per_op.size() > 1
+                      ? std::sqrt(result.stddev / (ns_per_op.size() - 1))
+                      : 0.;
+  result.min = ns_per_op.front();
+  result.p50 = percentile(.5);
+  result.p90 = percentile(.9);
+  result.p99 = percentile(.99);
+  return result;
+}
+
+inline std::string to_string(const bench_result& result) {
+  std::ostringstream str{};
+  str << std::fixed << std::setprecision(2) << result.mean
+      << " ns/op (p50 " << result.p50 << ", p90 " << result.p90 << ", p99 "
+      << result.p99 << ", stddev " << result.stddev << "; " << result.samples
+      << " x " << result.iterations << " iterations)";
+  return str.str();
+}
+
+/**
+ * Runs GBENCH body, each time with a fresh fixture (SUT and mocks)
+ *
+ * The number of MEASURE loop iterations is calibrated (growing x2 to x10)
+ * until a pass takes `sample_time`, then one warmup pass and `samples` passes
+ * are measured.
+ *
+ * `--gunit_bench_samples=N` (GUNIT_BENCH_SAMPLES, 10 by default)
+ * `--gunit_bench_time=ms` (GUNIT_BENCH_TIME, 10 ms per sample by default)
+ */
+class BenchRun {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  // benchmarks are not run by `--gunit_jobs` workers
+  static constexpr auto parallel = false;
+
+  struct iteration {};
+
+  class iterator {
+   public:
+    iterator(BenchRun& run, std::size_t left) : run_{run}, left_{left} {}
+
+    bool operator!=(const iterator&) {
+      if (left_) {
+        return true;
+      }
+      run_.stop();
+      return false;
+    }
+    iterator& operator++() {
+      --left_;
+      return *this;
+    }
+    iteration operator*() const { return {}; }
+
+   private:
+    BenchRun& run_;
+    std::size_t left_{};
+  };
+
+  std::size_t samples = flag_or("bench_samples", 10);
+  std::chrono::nanoseconds sample_time =
+      std::chrono::milliseconds{flag_or("bench_time", 10)};
+
+  /**
+   * @param pass creates a fixture and runs the GBENCH body once
+   */
+  template <class TPass>
+  void run(const TPass& pass) {
+    for (iterations_ = 1;; iterations_ = next(iterations_, elapsed_)) {
+      if (!measure(pass)) {
+        return;
+      }
+      if (elapsed_ >= sample_time || iterations_ >= max_iterations) {
+        break;
+      }
+    }
+
+    if (!measure(pass)) {  // warmup
+      return;
+    }
+
+    std::vector<double> ns_per_op{};
+    for (auto i = 0u; i < samples; ++i) {
+      if (!measure(pass)) {
+        return;
+      }
+      ns_per_op.push_back(double(elapsed_.count()) / iterations_);
+    }
+
+    result = make_bench_result(ns_per_op, iterations_);
+    print_progress("BENCH", to_string(result));
+    Test::RecordProperty("ns_per_op", format(result.mean));
+    Test::RecordProperty("ns_per_op_p50", format(result.p50));
+    Test::RecordProperty("ns_per_op_p99", format(result.p99));
+  }
+
+  iterator begin() {
+    measured_ = true;
+    start_ = clock::now();
+    return {*this, iterations_};
+  }
+
+  iterator end() { return {*this, 0}; }
+
+  bench_result result{};
+
+ private:
+  static constexpr std::size_t max_iterations = 1'000'000'000;
+
+  static std::size_t flag_or(const std::string& name, std::size_t value) {
+    const auto f = flag(name);
+    return f.empty() ? value : std::strtoul(f.c_str(), nullptr, 10);
+  }
+
+  static std::string format(double value) {
+    std::ostringstream str{};
+    str << std::fixed << std::setprecision(2) << value;
+    return str.str();
+  }
+
+  std::size_t next(std::size_t iterations, clock::duration elapsed) const {
+    const auto multiplier =
+        elapsed.count() > 0
+            ? std::min(10., std::max(1.4 * sample_time.count() /
+                                         std::chrono::duration_cast<
+                                             std::chrono::nanoseconds>(elapsed)
+                                             .count(),
+                                     2.))
+            : 10.;
+    return std::min(max_iterations,
+                    std::max(iterations + 1,
+                             std::size_t(iterations * multiplier)));
+  }
+
+  template <class TPass>
+  bool measure(const TPass& pass) {
+    measured_ = false;
+    elapsed_ = {};
+    pass(*this);
+    if (!measured_) {
+      report_failure("GBENCH has to MEASURE the benchmarked code");
+      return false;
+    }
+    return !Test::HasFailure();
+  }
+
+  void stop() { elapsed_ = clock::now() - start_; }
+
+  std::size_t iterations_{};
+  bool measured_{};
+  clock::time_point start_{};
+  clock::duration elapsed_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
+
+#define GBENCH(...)                                     \
+  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__)) \
+  (::testing::detail::BenchRun, false, __VA_ARGS__)  // NOLINT
+#define DISABLED_GBENCH(...)                            \
+  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__)) \
+  (::testing::detail::BenchRun, true, __VA_ARGS__)  // NOLINT
+
+#define MEASURE \
+  for (auto&& gbench_iteration __attribute__((unused)) : tr_gtest)
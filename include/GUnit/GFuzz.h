@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/FuzzUtils.h"
+#include "GUnit/Detail/ProcUtils.h"
+#include "GUnit/Detail/RunnerUtils.h"
+#include "GUnit/Detail/TermUtils.h"
+#include "GUnit/GTest.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+/**
+ * Fuzzed bytes to the GFUZZ input (std::string, std::vector<std::uint8_t> or
+ * a trivially copyable type)
+ */
+template <class T>
+struct fuzz_input {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "GFUZZ input has to be std::string, std::vector<std::uint8_t> "
+                "or a trivially copyable type");
+  static constexpr std::size_t size = sizeof(T);
+  static T make(const bytes& data) {
+    T value{};
+    std::memcpy(&value, data.data(), std::min(data.size(), sizeof(T)));
+    return value;
+  }
+};
+
+template <>
+struct fuzz_input<std::string> {
+  static constexpr std::size_t size = 0;
+  static std::string make(const bytes& data) {
+    return {data.begin(), data.end()};
+  }
+};
+
+template <>
+struct fuzz_input<std::vector<std::uint8_t>> {
+  static constexpr std::size_t size = 0;
+  static std::vector<std::uint8_t> make(const bytes& data) { return data; }
+};
+
+/**
+ * Runs GFUZZ body in a loop on inputs generated by the `fuzzer`, each time
+ * with a fresh fixture (SUT and mocks)
+ *
+ * `--gunit_fuzz_runs=N` (GUNIT_FUZZ_RUNS, 10000 by default)
+ * `--gunit_fuzz_time=ms` (GUNIT_FUZZ_TIME, stops earlier if set)
+ * `--gunit_fuzz_max_size=N` (GUNIT_FUZZ_MAX_SIZE, 1024 bytes by default)
+ * `--gunit_fuzz_seed=N` (GUNIT_FUZZ_SEED, derived from the test name by
+ * default, so that runs are reproducible)
+ * `--gunit_fuzz_corpus=<dir>` (GUNIT_FUZZ_CORPUS) keeps the corpus of every
+ * test in `<dir>/<test name>`
+ */
+template <class TInput>
+class FuzzRun {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  static constexpr auto parallel = true;  // can be run by `--gunit_jobs`
+
+  fuzz_options options = default_options();
+
+  /**
+   * @param pass creates a fixture and runs the GFUZZ body once
+   */
+  template <class TPass>
+  void run(const TPass& pass) {
+    if (jobs().replay()) {
+      return;
+    }
+    const auto name = test_name(*jobs().current_test());
+    if (flag("fuzz_seed").empty()) {
+      options.seed = fnv1a({name.begin(), name.end()});
+    }
+    if (!options.corpus.empty()) {
+      options.corpus += '/' + directory(name);
+    }
+
+    fuzz_result result{};
+    const auto start = clock::now();
+    {
+      auto failed = false;
+      intercept_results intercept{
+          [&failed](const TestPartResult& result) {
+            failed |= result.failed();
+          },
+          true};
+      fuzzer f{options, [&](const bytes& data) {
+                 failed = false;
+                 run(pass, data);
+                 return failed;
+               }};
+      result = f.run();
+    }
+    const auto elapsed = clock::now() - start;
+
+    if (result.failed) {
+      std::ostringstream str{};
+      str << "GFUZZ failed after " << result.runs << " runs (seed "
+          << options.seed << ")\n  Input: "
+          << PrintToString(fuzz_input<TInput>::make(result.input))
+          << " (minimized from " << result.original_size << " to "
+          << result.input.size() << " bytes)";
+      report_failure(str.str());
+      run(pass, result.input);  // reports the failures of the input
+    }
+
+    std::ostringstream str{};
+    str << result.runs << " runs, " << result.corpus << " inputs, "
+        << result.features << " features"
+        << (fuzzer::has_coverage() ? "" : " (no coverage)") << ", "
+        << std::fixed << std::setprecision(0)
+        << result.runs /
+               std::max(std::chrono::duration<double>(elapsed).count(), 1e-9)
+        << " exec/s";
+    print_progress("FUZZ", str.str(), true);
+  }
+
+  const TInput& input() const { return input_; }
+
+ private:
+  static fuzz_options default_options() {
+    const auto flag_or = [](const std::string& name, std::size_t value) {
+      const auto f = flag(name);
+      return f.empty() ? value
+                       : std::size_t(std::strtoull(f.c_str(), nullptr, 10));
+    };
+    fuzz_options options{};
+    options.runs = flag_or("fuzz_runs", options.runs);
+    options.time = std::chrono::milliseconds{flag_or("fuzz_time", 0)};
+    options.max_size = flag_or("fuzz_max_size", options.max_size);
+    options.fixed_size = fuzz_input<TInput>::size;
+    options.seed = flag_or("fuzz_seed", 0);
+    options.corpus = flag("fuzz_corpus");
+    return options;
+  }
+
+  static std::string directory(std::string name) {
+    for (auto& c : name) {
+      c = std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return name;
+  }
+
+  template <class TPass>
+  void run(const TPass& pass, const bytes& data) {
+    input_ = fuzz_input<TInput>::make(data);
+    try {
+      pass(*this);
+    } catch (...) {
+      report_exception("in the test body");
+    }
+  }
+
+  TInput input_{};
+};
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
+
+#define GFUZZ(NAME, INPUT) \
+  __GTEST_IMPL_1(::testing::detail::FuzzRun<INPUT>, false, NAME)  // NOLINT
+#define DISABLED_GFUZZ(NAME, INPUT) \
+  __GTEST_IMPL_1(::testing::detail::FuzzRun<INPUT>, true, NAME)  // NOLINT
+
+#define FUZZ_INPUT tr_gtest.input()
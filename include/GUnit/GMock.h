@@ -9,17 +9,23 @@
 
 #include <gmock/gmock.h>
 
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "GUnit/Detail/AllocUtils.h"
 #include "GUnit/Detail/FileUtils.h"
 #include "GUnit/Detail/Preprocessor.h"
 #include "GUnit/Detail/ProgUtils.h"
@@ -211,6 +217,110 @@ FailUninterestingCallsType FailUninterestingCalls();
 template struct GetAccessFailUninterestingCallsType<
     &Mock::FailUninterestingCalls>;
 
+using UntypedExpectationsType =
+    std::vector<std::shared_ptr<internal::ExpectationBase>>
+        internal::UntypedFunctionMockerBase::*;
+template <UntypedExpectationsType Ptr>
+struct GetAccessUntypedExpectationsType {
+  friend UntypedExpectationsType UntypedExpectations() { return Ptr; }
+};
+UntypedExpectationsType UntypedExpectations();
+template struct GetAccessUntypedExpectationsType<
+    &internal::UntypedFunctionMockerBase::untyped_expectations_>;
+
+using CallCountType = int internal::ExpectationBase::*;
+template <CallCountType Ptr>
+struct GetAccessCallCountType {
+  friend CallCountType CallCount() { return Ptr; }
+};
+CallCountType CallCount();
+template struct GetAccessCallCountType<&internal::ExpectationBase::call_count_>;
+
+/**
+ * Mocked functions of the alive GMocks with EXPECT_CALLs, so that a hung test
+ * can tell which expectations it's still waiting for
+ *
+ * Nothing is tracked until the watchdog enables it (`--gunit_timeout`), so
+ * EXPECT_CALL doesn't pay for the lock otherwise.
+ */
+class expectations_registry {
+ public:
+  void enable() { enabled_.store(true, std::memory_order_relaxed); }
+
+  void add(const internal::UntypedFunctionMockerBase *mocker) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    mockers_.insert(mocker);
+  }
+
+  void remove(const internal::UntypedFunctionMockerBase *mocker) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;  // nothing has been added
+    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    mockers_.erase(mocker);
+  }
+
+  /**
+   * Reads the expectations under `g_gmock_mutex`, unless the hung thread
+   * doesn't release it within 100 ms
+   *
+   * @return "\nOutstanding expectations:" followed by the unsatisfied
+   * expectations, empty if there are none (or they can't be read)
+   */
+  std::string outstanding() const {
+#if GTEST_HAS_PTHREAD
+    const std::lock_guard<std::mutex> lock{mutex_};
+    auto &gmock_mutex = internal::g_gmock_mutex.mutex_;
+    for (auto i = 0; pthread_mutex_trylock(&gmock_mutex); ++i) {
+      if (i == 100) {
+        return "\nOutstanding expectations: unknown (Google Mock is locked)";
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    const std::unique_ptr<pthread_mutex_t, int (*)(pthread_mutex_t *)> unlock{
+        &gmock_mutex, &pthread_mutex_unlock};
+    const auto expectations = unsatisfied();
+    return expectations.empty()
+               ? expectations
+               : "\nOutstanding expectations:" + expectations;
+#else
+    return {};  // g_gmock_mutex can't be waited for with a timeout
+#endif
+  }
+
+ private:
+  std::string unsatisfied() const {
+    std::stringstream result{};
+    for (const auto &mocker : mockers_) {
+      for (const auto &e : (*mocker).*UntypedExpectations()) {
+        const auto calls = (*e).*CallCount();
+        if (e->cardinality().IsSatisfiedByCallCount(calls)) {
+          continue;
+        }
+        result << "\n  "
+               << internal::FormatFileLocation(e->file(), e->line())
+               << " " << e->source_text() << " - ";
+        Cardinality::DescribeActualCallCountTo(calls, &result);
+        result << ", expected: ";
+        e->cardinality().DescribeTo(&result);
+      }
+    }
+    return result.str();
+  }
+
+  std::atomic<bool> enabled_{};
+  mutable std::mutex mutex_{};
+  std::unordered_set<const internal::UntypedFunctionMockerBase *> mockers_{};
+};
+
+inline expectations_registry &expectations() {
+  static expectations_registry registry{};
+  return registry;
+}
+
 }  // namespace detail
 
 template <class T>
@@ -228,6 +338,7 @@ class GMock {
 
   template <class TName = detail::string<>, class R = void *, class... TArgs>
   R not_expected(TArgs... args) {
+    const detail::ignore_allocations ignore{};
     const auto addr = static_cast<void*>((static_cast<int *>(__builtin_return_address(0)) - 1));
     auto *ptr = [this] {
       fs[__PRETTY_FUNCTION__] = std::make_unique<FunctionMocker<R(TArgs...)>>();
@@ -260,6 +371,7 @@ class GMock {
   template <class TName, class R, class... TArgs>
   decltype(auto) gmock_call_impl(
       std::size_t offset, const detail::identity_t<Matcher<TArgs>> &... args) {
+    const detail::ignore_allocations ignore{};
     vtable.set(offset, detail::union_cast<void *>(
                            &GMock::template original_call<TName, R, TArgs...>));
 
@@ -274,11 +386,13 @@ class GMock {
     }();
 
     ptr->RegisterOwner(this);
+    detail::expectations().add(ptr);
     return ptr->With(args...);
   }
 
   template <class TName, class R, class... TArgs>
   R original_call(TArgs... args) {
+    const detail::ignore_allocations ignore{};
     if (fs.find(TName::c_str()) != fs.end()) {
       auto *f =
           static_cast<FunctionMocker<R(TArgs...)> *>(fs[TName::c_str()].get());
@@ -305,6 +419,7 @@ class GMock {
 
   template <class TName, class R, class... TArgs>
   void original_defer_call(TArgs... args) {
+    const detail::ignore_allocations ignore{};
     calls.push_back([this, args...] { original_call<TName, R>(args...); });
   }
 
@@ -320,6 +435,9 @@ class GMock {
     for (const auto &call : calls) {
       call();
     }
+    for (const auto &f : fs) {
+      detail::expectations().remove(f.second.get());
+    }
   }
 
   template <class... Ts>
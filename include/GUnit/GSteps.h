@@ -9,10 +9,12 @@
 #include <gtest/gtest.h>
 
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <functional>
 #include <gherkin.hpp>
 #include <json.hpp>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -21,9 +23,13 @@
 #include <vector>
 
 #include "GUnit/Detail/FileUtils.h"
+#include "GUnit/Detail/JournalUtils.h"
 #include "GUnit/Detail/Preprocessor.h"
 #include "GUnit/Detail/RegexUtils.h"
+#include "GUnit/Detail/RegistryUtils.h"
+#include "GUnit/Detail/RunnerUtils.h"
 #include "GUnit/Detail/StringUtils.h"
+#include "GUnit/Detail/TermUtils.h"
 #include "GUnit/Detail/Utility.h"
 #include "formatters/features.hpp"
 #include "formatters/gherkinCpp/background.hpp"
@@ -312,9 +318,10 @@ class Steps : public ::testing::EmptyTestEventListener {
         std::cout << path << std::endl;
         Features::getInstance()->addReport(path);
       }
-      for (const auto& feature : detail::split(scenario, ':')) {
-        info_.file = feature;
-        ParseAndRegister(TFeature::c_str(), feature);
+      // Features are parsed once Google Test flags are known
+      detail::lazy_registry::add(registry_entry_);
+      if (detail::journal().is_enabled()) {
+        (void)detail::jobs();  // installs the journal recorder
       }
     }
   }
@@ -418,6 +425,14 @@ class Steps : public ::testing::EmptyTestEventListener {
     currentElement = element;
   }
 
+  static void RegisterFeatures(void* self, const detail::filter&) {
+    auto& steps = *static_cast<Steps*>(self);
+    for (const auto& feature : detail::split(std::getenv("SCENARIO"), ':')) {
+      steps.info_.file = feature;
+      steps.ParseAndRegister(TFeature::c_str(), feature);
+    }
+  }
+
   void ParseAndRegister(const std::string& name, const std::string& feature) {
     try {
       const auto content = read_file(feature);
@@ -608,25 +623,32 @@ class Steps : public ::testing::EmptyTestEventListener {
             const auto name = given_step.second.first.name;
             const auto file = given_step.second.first.file;
 
-            std::cout << "\033[0;96m"
-                      << "[ " << std::right << std::setw(8) << name << " ] " << std::left << std::setw(60) << expectedStep.second->name << "# ";
+            std::ostringstream progress{};
+            progress << "\033[0;96m"
+                     << "[ " << std::right << std::setw(8) << name << " ] " << std::left << std::setw(60) << expectedStep.second->name << "# ";
 
             {
               const auto file = file_.substr(file_.find_last_of("/\\") + 1);
               const auto line = expected_step["locations"].back()["line"].template get<int>();
-              std::cout << file << ":" << line;
+              progress << file << ":" << line;
             }
 
             if (not file.empty()) {
               const auto line = given_step.second.first.line;
-              std::cout << " " << file << ":" << line;
+              progress << " " << file << ":" << line;
             }
 
-            std::cout << "\033[m" << '\n';
+            progress << "\033[m" << '\n';
+            detail::print_progress(progress.str());
 
             info_.step = expectedStep.second->name;
+            const auto failed = detail::failures().load();
+            const auto start = std::chrono::steady_clock::now();
             given_step.second.second(expectedStep.second->name,
                                      detail::make_table(expected_step));
+            journal_step(expectedStep.second->name,
+                         detail::failures() != failed,
+                         std::chrono::steady_clock::now() - start);
             found = true;
             line_ = tmp_line;
           }
@@ -639,6 +661,23 @@ class Steps : public ::testing::EmptyTestEventListener {
     }   /* for(const auto& expectedStep : currentElement->getSteps()) */
   }     /*  NextStep() */
 
+  /// Steps are journaled with `--gunit_journal` under their scenario test
+  static void journal_step(const std::string& step, bool failed,
+                           std::chrono::steady_clock::duration elapsed) {
+    const auto test = UnitTest::GetInstance()->current_test_info();
+    if (!detail::journal().is_enabled() || !test) {
+      return;
+    }
+    detail::journal().append(
+        detail::journal_kind::STEP,
+        failed ? detail::journal_status::FAILED
+               : detail::journal_status::PASSED,
+        std::uint64_t(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                .count()),
+        detail::test_name(*test), step);
+  }
+
   // Called after a failed assertion.
   virtual void OnTestPartResult(
       const ::testing::TestPartResult& test_part_result) {
@@ -673,6 +712,8 @@ class Steps : public ::testing::EmptyTestEventListener {
       return os;
     }
   } info_;
+
+  detail::lazy_registry::entry registry_entry_{&RegisterFeatures, this};
 };
 }  // namespace detail
 }  // namespace v1
@@ -10,18 +10,35 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
-#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
+#include "GUnit/Detail/FlagUtils.h"
+#include "GUnit/Detail/JournalUtils.h"
+#include "GUnit/Detail/ParamUtils.h"
 #include "GUnit/Detail/Preprocessor.h"
+#include "GUnit/Detail/ProcUtils.h"
 #include "GUnit/Detail/RegexUtils.h"
+#include "GUnit/Detail/RegistryUtils.h"
+#include "GUnit/Detail/RunnerUtils.h"
+#include "GUnit/Detail/StatsUtils.h"
 #include "GUnit/Detail/StringUtils.h"
 #include "GUnit/Detail/TermUtils.h"
 #include "GUnit/Detail/TypeTraits.h"
+#include "GUnit/Detail/WatchdogUtils.h"
 #include "GUnit/GMake.h"
 #include "GUnit/GMock.h"
 
@@ -48,57 +65,549 @@ typename ParamNameGenFunc<ParamType>::Type* GetParamNameGen() {
 inline namespace v1 {
 namespace detail {
 
+/**
+ * SHOULD filter (`--gtest_filter=Test.Name:<should filter>`), compiled once
+ * per `GTEST_FLAG(filter)` value and shared by all tests
+ */
+inline std::shared_ptr<const filter> should_filter() {
+  static std::mutex mutex{};
+  static std::string gtest_filter{};
+  static std::shared_ptr<const filter> compiled{};
+  const std::lock_guard<std::mutex> lock{mutex};
+  if (!compiled || gtest_filter != GTEST_FLAG(filter)) {
+    gtest_filter = GTEST_FLAG(filter);
+    const auto sep = gtest_filter.find(':');
+    compiled = std::make_shared<const filter>(
+        sep == std::string::npos ? "*" : gtest_filter.substr(sep + 1));
+  }
+  return compiled;
+}
+
+/**
+ * Runs GTEST body once per SHOULD section (see docs/GTest.md)
+ */
 struct TestRun {
-  std::string should_param = GetShouldParam();
-  bool next = true;
+  static constexpr auto parallel = true;  // can be run by `--gunit_jobs`
+
+  struct section {
+    std::string type{};
+    std::string name{};
+    bool matches{};
+    bool disabled{};
+    bool done{};
+  };
+
+  std::shared_ptr<const filter> should_filter = detail::should_filter();
+  bool next = false;
+  bool fork_sections = fork_flag();
+  std::size_t threads = threads_flag();
+  std::chrono::milliseconds timeout = timeout_flag();
+
+  /**
+   * @param pass creates a fixture and runs the GTEST body once
+   */
+  template <class TPass>
+  void run(const TPass& pass) {
+    if (jobs().replay()) {
+      return;
+    }
+#if GUNIT_HAS_FORK
+    if (fork_sections) {
+      run_forked(pass);
+      return;
+    }
+#endif
+    do {  // until a pass goes on after its section (or runs none)
+      next = resumed = false;
+      const auto start = current_usage(stats().is_enabled());
+      const auto failed = failures().load();
+      arm();
+      pass(*this);
+      watchdog_guard.reset();
+      if (next) {
+        record(sections[test_line].name, start, failures() != failed);
+      }
+    } while (next && !resumed);
+    if (threads > 1) {
+      run_parallel(pass);
+      return;
+    }
+    while (advance()) {
+      next = false;
+      const auto start = current_usage(stats().is_enabled());
+      const auto failed = failures().load();
+      arm();
+      pass(*this);
+      watchdog_guard.reset();
+      record(sections[target_line].name, start, failures() != failed);
+    }
+  }
 
-  std::string GetShouldParam() const {
-    const auto sep = GTEST_FLAG(filter).find(":");
-    return sep == std::string::npos ? "*" : GTEST_FLAG(filter).substr(sep + 1);
+  bool run(const char* type, const std::string& name, int line,
+           bool disabled = false) {
+    return run(type, name.c_str(), line, disabled);
   }
 
-  bool run(const std::string& type, const std::string& name, int line,
+  bool run(const char* type, const char* name, int line,
            bool disabled = false) {
-    if (next) {
+    if (discovered) {
+      if (sections.find(line) == sections.end()) {  // reached by this pass only
+        sections[line] = {type, name, (*should_filter)(name), disabled};
+      }
+      if (next || line != target_line) {
+        return false;
+      }
+      if (!quiet) {
+        print(type, name);
+      }
+      current_section = &sections[line];
+      test_line = line;
+      next = true;
+      return true;
+    }
+
+    resumed = next;
+    const auto it = sections.find(line);
+    if (it != sections.end()) {
+      return false;  // same guard executed again (loop)
+    }
+    auto& s = sections[line] = {
+        type, name, (*should_filter)(name), disabled};
+    if (next || !s.matches) {
+      return false;
+    }
+
+    if (disabled && !GTEST_FLAG(also_run_disabled_tests)) {
+      print("DISABLED", name, true);
+      s.matches = false;
+      return false;
+    }
+
+#if GUNIT_HAS_FORK
+    if (fork_sections) {
+      print(type, name);
+      ignored.reset();         // child results have to reach the test
+      watchdog_guard.reset();  // the child has its own
+      const auto start = current_usage(stats().is_enabled());
+      const auto failed = failures().load();
+      if (child.fork(name)) {
+        arm();
+        current_section = &s;
+        return next = true;
+      }
+      record(name, start, failures() != failed);
+      arm();
+      ignored = std::make_unique<intercept_results>(  // reported by the child
+          [this, section = std::string{name}](const TestPartResult& result) {
+            if (result.fatally_failed() && stopped_after.empty()) {
+              stopped_after = section;  // the body returns, no more forks
+            }
+          });
       return false;
     }
+#endif
+
+    print(type, name);
+    current_section = &s;
+    s.done = true;
+    test_line = line;
+    next = true;
+    return true;
+  }
+
+  int test_line = 0;
 
-    const auto indented_name = "    " + name;
+ private:
+  static bool fork_flag() {
+    static const auto fork = GUNIT_HAS_FORK && is_flag_enabled("fork");
+    return fork;
+  }
 
-    const auto result =
-        line > test_line && FilterMatchesShould(name, should_param);
-    if (result) {
-      static const bool is_stdout_tty = ShouldUseColor(
-          internal::posix::IsATTY(internal::posix::FileNo(stdout)) != 0);
-      const auto colorize = ShouldUseColor(is_stdout_tty);
+  static std::chrono::milliseconds timeout_flag() {
+    static const std::chrono::milliseconds timeout{
+        std::strtoul(flag("timeout").c_str(), nullptr, 10)};
+    return timeout;
+  }
 
-      if (disabled && !GTEST_FLAG(also_run_disabled_tests)) {
-        if (colorize) {
-          std::cout << "\33[0;33m\033[2m";
-        }
-        std::cout << "[ DISABLED ] ";
-        if (colorize) {
-          std::cout << "\033[m";  // Resets the terminal to default.
+  void arm() {
+    watchdog_guard.reset();
+    current_section = nullptr;
+    if (!timeout.count()) {
+      return;
+    }
+    expectations().enable();  // before the EXPECT_CALLs of the pass
+    const auto test = jobs().current_test();
+    watchdog_guard = watchdog().arm(
+        timeout, [this, name = test ? test_name(*test) : std::string{}] {
+          std::string description = " by \"" + name + '"';
+          if (const auto s = current_section.load()) {
+            description += ", " + s->type + " \"" + s->name + '"';
+          }
+          return description + expectations().outstanding();
+        });
+  }
+
+  void record(const std::string& name, const resource_usage& start,
+              bool failed) const {
+    if (const auto s = measure(name, start, failed)) {
+      record(*s);
+    }
+  }
+
+  void record(const section_stats& s) const {
+    stats().record(s);
+    if (stats().is_printed()) {
+      print("STATS", to_string(s), true);
+    }
+  }
+
+  /**
+   * Records the wall time in the timings journal and the result in the
+   * results journal
+   *
+   * @return resource usage of the section if stats are enabled
+   */
+  std::unique_ptr<section_stats> measure(const std::string& name,
+                                         const resource_usage& start,
+                                         bool failed) const {
+    const auto test = jobs().current_test();
+    if (!test) {
+      return {};
+    }
+    const auto end = current_usage(stats().is_enabled());
+    if (timings().is_enabled()) {
+      timings().record(section_name(*test, name), end.wall - start.wall);
+    }
+    if (journal().is_enabled()) {
+      journal().append(
+          journal_kind::SECTION,
+          failed ? journal_status::FAILED : journal_status::PASSED,
+          std::uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                            end.wall - start.wall)
+                            .count()),
+          test_name(*test), name);
+    }
+    if (!stats().is_enabled()) {
+      return {};
+    }
+    return std::make_unique<section_stats>(
+        make_section_stats(test_name(*test), name, start, end));
+  }
+
+  static std::string section_name(const TestInfo& test,
+                                  const std::string& name) {
+    return test_name(test) + '/' + name;
+  }
+
+#if GUNIT_HAS_FORK
+  template <class TPass>
+  void run_forked(const TPass& pass) {
+    arm();
+    try {
+      pass(*this);
+    } catch (...) {
+      if (!child.is_child()) {
+        throw;
+      }
+      report_exception("in the section");
+    }
+    if (child.is_child()) {
+      child.finish();
+    }
+    watchdog_guard.reset();
+    ignored.reset();
+    if (!stopped_after.empty()) {
+      report_failure("Fatal failure following the section \"" +
+                     stopped_after +
+                     "\" in the parent process, the sections after it were "
+                     "skipped.");
+    }
+  }
+#endif
+
+  template <class TPass>
+  void run_parallel(const TPass& pass) {
+    struct job {
+      int line{};
+      const section* s{};
+      std::unique_ptr<section_stats> stats{};
+      std::promise<void> done{};
+      std::future<void> ready = done.get_future();
+    };
+
+    std::vector<job> jobs{};
+    for (auto& s : sections) {
+      if (s.second.matches && !s.second.done) {
+        jobs.push_back(job{s.first, &s.second});
+      }
+    }
+
+    // the failed and the longest sections start first
+    std::vector<std::size_t> order(jobs.size());
+    for (auto i = 0u; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    if (const auto test = detail::jobs().current_test()) {
+      std::stable_sort(order.begin(), order.end(),
+                       [&](std::size_t lhs, std::size_t rhs) {
+                         return timings().before(
+                             section_name(*test, jobs[lhs].s->name),
+                             section_name(*test, jobs[rhs].s->name));
+                       });
+    }
+
+    std::atomic<std::size_t> next_job{};
+    const auto worker = [&] {
+      for (auto i = next_job++; i < jobs.size(); i = next_job++) {
+        auto& j = jobs[order[i]];
+        if (j.s->disabled && !GTEST_FLAG(also_run_disabled_tests)) {
+          print("DISABLED", j.s->name, true);
+        } else {
+          TestRun tr{};
+          tr.should_filter = should_filter;
+          tr.fork_sections = false;
+          tr.threads = 0;
+          tr.timeout = timeout;
+          tr.discovered = true;
+          tr.quiet = true;
+          tr.target_line = j.line;
+          auto failed = false;
+          const auto start = current_usage(stats().is_enabled());
+          tr.arm();
+          {
+            observe_results observe{[&failed](const TestPartResult& result) {
+              failed = failed || result.failed();
+            }};
+            print(j.s->type, j.s->name);
+            try {
+              pass(tr);
+            } catch (...) {
+              report_exception("in the section");
+            }
+          }
+          j.stats = measure(j.s->name, start, failed);
         }
-        std::cout << indented_name << std::endl;
-        return false;
+        j.done.set_value();
+      }
+    };
+
+    std::vector<std::thread> workers{};
+    for (auto i = 0u; i < std::min(threads, jobs.size()); ++i) {
+      workers.emplace_back(worker);
+    }
+    for (auto& j : jobs) {
+      j.ready.wait();
+      if (j.stats) {
+        record(*j.stats);
       }
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+  }
 
-      if (colorize) {
-        std::cout << "\033[0;33m";
+  bool advance() {
+    discovered = true;
+    for (auto it = sections.begin(); it != sections.end(); ++it) {
+      auto& s = it->second;
+      if (!s.matches || s.done) {
+        continue;
       }
-      std::cout << "[ " << std::left << std::setw(8) << type << " ] ";
-      if (colorize) {
-        std::cout << "\033[m";  // Resets the terminal to default.
+      if (s.disabled && !GTEST_FLAG(also_run_disabled_tests)) {
+        print("DISABLED", s.name, true);
+        s.matches = false;
+        continue;
       }
-      std::cout << indented_name << std::endl;
-      test_line = line;
-      next = true;
+      s.done = true;
+      target_line = it->first;
+      return true;
     }
-    return result;
+    return false;
   }
 
-  int test_line = 0;
+  static void print(const std::string& type, const std::string& name,
+                    bool dim = false) {
+    print_progress(type, name, dim);
+  }
+
+  std::map<int, section> sections{};
+  bool discovered = false;
+  bool resumed = false;  // a guard was reached after the section of the pass
+  bool quiet = false;
+  int target_line = 0;
+  std::atomic<const section*> current_section{};  // read by the watchdog
+  std::unique_ptr<hang_watchdog::guard> watchdog_guard{};
+#if GUNIT_HAS_FORK
+  child_process child{};
+  std::unique_ptr<intercept_results> ignored{};
+  std::string stopped_after{};  // section followed by a fatal failure
+#endif
+};
+
+/**
+ * Runs GTEST_LAZY body once per parameter of the `Source()` range, each time
+ * with a fresh fixture
+ *
+ * Parameters are produced while the test runs (nothing is registered nor kept
+ * per parameter). Failures are reported with the index and the value of the
+ * parameter, an exception fails the parameter and the following ones still
+ * run.
+ *
+ * With `--gunit_threads=N` (GUNIT_THREADS=N) the parameters are run on N
+ * threads, their failures are reported in the parameter order (unless too
+ * many parameters finish ahead of a slow one).
+ */
+template <auto Source>
+class LazyParamRun {
+  using source_type = std::decay_t<decltype(Source())>;
+
+ public:
+  using param_type = std::decay_t<decltype(*std::begin(
+      std::declval<source_type&>()))>;
+
+  static constexpr auto parallel = true;  // can be run by `--gunit_jobs`
+
+  std::size_t threads = threads_flag();
+
+  /**
+   * @param pass creates a fixture and runs the GTEST_LAZY body once
+   */
+  template <class TPass>
+  void run(const TPass& pass) {
+    if (jobs().replay()) {
+      return;
+    }
+    std::size_t params{};
+    std::size_t failed{};
+    try {
+      auto source = Source();
+      if (threads > 1) {
+        run_parallel(pass, source, params, failed);
+      } else {
+        run_serial(pass, source, params, failed);
+      }
+    } catch (...) {
+      report_exception("by the parameters of the test");
+    }
+    print_progress("PARAMS", std::to_string(params) + " run, " +
+                                 std::to_string(failed) + " failed",
+                   true);
+  }
+
+  const param_type& param() const { return *param_; }
+
+ private:
+  // parameters finished ahead of a slower one kept for the parameter order
+  static constexpr std::size_t max_pending = 256;
+
+  template <class TPass>
+  void run_serial(const TPass& pass, source_type& source, std::size_t& index,
+                  std::size_t& failed) {
+    for (const auto& param : source) {
+      report(run(pass, index, param), failed);
+      ++index;
+    }
+  }
+
+  template <class TPass>
+  void run_parallel(const TPass& pass, source_type& source, std::size_t& index,
+                    std::size_t& failed) {
+    std::mutex mutex{};
+    auto it = std::begin(source);
+    const auto end = std::end(source);
+    std::exception_ptr error{};
+    std::map<std::size_t, std::vector<TestPartResult>> pending{};
+    std::size_t next{};  // the first parameter not reported yet
+    const auto worker = [&] {
+      for (;;) {
+        std::unique_ptr<param_type> param{};
+        std::size_t i{};
+        {
+          const std::lock_guard<std::mutex> lock{mutex};
+          if (error || !(it != end)) {
+            return;
+          }
+          try {
+            param = std::make_unique<param_type>(*it);
+            i = index++;
+            ++it;
+          } catch (...) {
+            error = std::current_exception();
+            return;
+          }
+        }
+        LazyParamRun tr{};
+        auto results = tr.run(pass, i, *param);
+        const std::lock_guard<std::mutex> lock{mutex};
+        pending.emplace(i, std::move(results));
+        for (auto p = pending.begin(); p != pending.end() &&
+                                       (p->first <= next ||
+                                        pending.size() > max_pending);
+             p = pending.erase(p)) {
+          report(p->second, failed);
+          next = std::max(next, p->first + 1);
+        }
+      }
+    };
+    std::vector<std::thread> workers{};
+    for (auto i = 0u; i < threads; ++i) {
+      workers.emplace_back(worker);
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    for (const auto& p : pending) {  // following a failed `Source()` step
+      report(p.second, failed);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * @return results of the parameter, prefixed with its index and value
+   */
+  template <class TPass>
+  std::vector<TestPartResult> run(const TPass& pass, std::size_t index,
+                                  const param_type& param) {
+    param_ = &param;
+    std::vector<TestPartResult> results{};
+    {
+      intercept_results intercept{
+          [&results](const TestPartResult& result) {
+            results.push_back(result);
+          },
+          true};
+      try {
+        pass(*this);
+      } catch (...) {
+        report_exception("in the test body");
+      }
+    }
+    param_ = nullptr;
+    if (results.empty()) {
+      return results;
+    }
+    const auto prefix = "Parameter #" + std::to_string(index) + " (" +
+                        PrintToString(param) + ")\n";
+    std::vector<TestPartResult> failed{};
+    for (const auto& result : results) {
+      failed.emplace_back(result.type(), result.file_name(),
+                          result.line_number(),
+                          (prefix + result.message()).c_str());
+    }
+    return failed;
+  }
+
+  static void report(const std::vector<TestPartResult>& results,
+                     std::size_t& failed) {
+    failed += !results.empty();
+    for (const auto& result : results) {
+      detail::report(result);
+    }
+  }
+
+  const param_type* param_{};
 };
 
 template <bool DISABLED, class T>
@@ -107,26 +616,45 @@ class GTestAutoRegister {
     return DISABLED || disabled ? "DISABLED_" : "";
   }
 
-  void MakeAndRegisterTestInfo(
-      bool disabled, const std::string& type, const std::string& name,
+  static TestInfo* MakeAndRegisterTestInfo(
+      const std::string& type, const std::string& name,
       const std::string& /*file*/, int /*line*/,
       detail::type<TestInfo*(const char*, const char*, const char*, const char*,
                              const void*, void (*)(), void (*)(),
                              internal::TestFactoryBase*)>) {
-    internal::MakeAndRegisterTestInfo(
-        (IsDisabled(disabled) + type).c_str(), name.c_str(), nullptr, nullptr,
+    return internal::MakeAndRegisterTestInfo(
+        type.c_str(), name.c_str(), nullptr, nullptr,
         internal::GetTestTypeId(), Test::SetUpTestCase, Test::TearDownTestCase,
         new internal::TestFactoryImpl<T>{});
   }
 
   template <class... Ts>
-  void MakeAndRegisterTestInfo(bool disabled, const std::string& type,
-                               const std::string& name, const std::string& file,
-                               int line, detail::type<TestInfo*(Ts...)>) {
-    internal::MakeAndRegisterTestInfo(
-        (IsDisabled(disabled) + type).c_str(), name.c_str(), nullptr, nullptr,
-        {file.c_str(), line}, internal::GetTestTypeId(), Test::SetUpTestCase,
-        Test::TearDownTestCase, new internal::TestFactoryImpl<T>{});
+  static TestInfo* MakeAndRegisterTestInfo(const std::string& type,
+                                           const std::string& name,
+                                           const std::string& file, int line,
+                                           detail::type<TestInfo*(Ts...)>) {
+    return internal::MakeAndRegisterTestInfo(
+        type.c_str(), name.c_str(), nullptr, nullptr, {file.c_str(), line},
+        internal::GetTestTypeId(), Test::SetUpTestCase, Test::TearDownTestCase,
+        new internal::TestFactoryImpl<T>{});
+  }
+
+  static void Register(void*, const filter& f) {
+    const auto type = std::string{IsDisabled(false)} +
+                      GetTypeName(detail::type<typename T::TEST_TYPE>{});
+    const std::string name = T::TEST_NAME::c_str();
+    if (!f((type + '.' + name).c_str())) {
+      return;
+    }
+    const auto info = MakeAndRegisterTestInfo(
+        type, name, T::TEST_FILE, T::TEST_LINE,
+        detail::type<decltype(internal::MakeAndRegisterTestInfo)>{});
+    if (T::TEST_RUNNER::parallel) {
+      jobs().add(info, [] {
+        T test;
+        test.TestBody();
+      });
+    }
   }
 
   template <class TestType>
@@ -142,12 +670,7 @@ class GTestAutoRegister {
   }
 
  public:
-  GTestAutoRegister() {
-    MakeAndRegisterTestInfo(
-        DISABLED, GetTypeName(detail::type<typename T::TEST_TYPE>{}),
-        T::TEST_NAME::c_str(), T::TEST_FILE, T::TEST_LINE,
-        detail::type<decltype(internal::MakeAndRegisterTestInfo)>{});
-  }
+  GTestAutoRegister() { lazy_registry::add(entry_); }
 
   template <class TEval, class TGenerateNames>
   GTestAutoRegister(const TEval& eval, const TGenerateNames& genNames) {
@@ -175,6 +698,9 @@ class GTestAutoRegister {
             (std::string{IsDisabled(DISABLED)} + T::TEST_NAME::c_str()).c_str(),
             eval, genNames, T::TEST_FILE, T::TEST_LINE);
   }
+
+ private:
+  lazy_registry::entry entry_{&Register, this};
 };
 
 template <class T, class TParamType, class = detail::is_complete<T>,
@@ -232,18 +758,49 @@ class GTest<T, TParamType, std::true_type, std::true_type> : public T {};
 template <class T = detail::none_t, class TParamType = void>
 class GTest : public detail::GTest<T, TParamType> {};
 
+using SectionStats = detail::section_stats;
+
+/**
+ * @return resource usage of the SHOULD sections run so far (`--gunit_stats`)
+ */
+inline std::vector<SectionStats> GetSectionStats() {
+  return detail::stats().sections();
+}
+
+/**
+ * GTEST_LAZY parameters returned by `next()` (`std::optional<T>`) until it
+ * returns `std::nullopt`
+ */
+template <class TNext>
+inline auto Generate(TNext next) {
+  return detail::generator<TNext>{std::move(next)};
+}
+
+/**
+ * GTEST_LAZY parameters read from a file, one per line
+ */
+inline auto Lines(const std::string& file) { return detail::lines{file}; }
+
 }  // namespace v1
 }  // namespace testing
 
-#define __GTEST_IMPL(DISABLED, TYPE, NAME, PARAMS, ...)                       \
-  struct __GUNIT_CAT(GTEST_STRING_, __LINE__) {                               \
-    const char* chrs = #TYPE;                                                 \
-  };                                                                          \
+#if GUNIT_HAS_FIXED_STRING
+#define __GTEST_MAKE_STRING_DECL(TYPE)
+#define __GTEST_MAKE_STRING_TYPE(TYPE) ::testing::detail::make_string_t<#TYPE>
+#else
+#define __GTEST_MAKE_STRING_DECL(TYPE)          \
+  struct __GUNIT_CAT(GTEST_STRING_, __LINE__) { \
+    const char* chrs = #TYPE;                   \
+  };
+#define __GTEST_MAKE_STRING_TYPE(TYPE)                          \
+  typename ::testing::detail::make_string<                      \
+      __GUNIT_CAT(GTEST_STRING_, __LINE__), sizeof(#TYPE)>::type
+#endif
+
+#define __GTEST_IMPL(RUNNER, DISABLED, TYPE, NAME, PARAMS, ...)               \
+  __GTEST_MAKE_STRING_DECL(TYPE)                                              \
   using __GUNIT_CAT(GTEST_TYPE_, __LINE__) = std::conditional_t<              \
-      #TYPE[(0)] == '"',                                                      \
-      decltype(::testing::detail::make_string<                                \
-               __GUNIT_CAT(GTEST_STRING_, __LINE__), sizeof(#TYPE)>::type()), \
-      __typeof__(TYPE)>;                                                      \
+      #TYPE[(0)] == '"', __GTEST_MAKE_STRING_TYPE(TYPE), __typeof__(TYPE)>;   \
   template <class...>                                                         \
   struct GTEST;                                                               \
   template <>                                                                 \
@@ -252,37 +809,36 @@ class GTest : public detail::GTest<T, TParamType> {};
                                  ::testing::detail::apply_t<                  \
                                      std::common_type_t, decltype(PARAMS)>> { \
     using TEST_TYPE = __GUNIT_CAT(GTEST_TYPE_, __LINE__);                     \
+    using TEST_RUNNER = RUNNER;                                               \
     using TEST_NAME = NAME;                                                   \
     static constexpr auto TEST_FILE = __FILE__;                               \
     static constexpr auto TEST_LINE = __LINE__;                               \
-    void TestBodyImpl(::testing::detail::TestRun&);                           \
+    void TestBodyImpl(RUNNER&);                                               \
     void TestBody() {                                                         \
-      ::testing::detail::TestRun tr;                                          \
-      while (tr.next) {                                                       \
-        tr.next = false;                                                      \
+      RUNNER{}.run([](RUNNER& tr) {                                           \
         GTEST test;                                                           \
         test.SetUp();                                                         \
         test.TestBodyImpl(tr);                                                \
         test.TearDown();                                                      \
-      };                                                                      \
+      });                                                                     \
     }                                                                         \
   };                                                                          \
   static ::testing::detail::GTestAutoRegister<                                \
       DISABLED, GTEST<__GUNIT_CAT(GTEST_TYPE_, __LINE__), NAME>>              \
       __GUNIT_CAT(ar, __LINE__){__VA_ARGS__};                                 \
   void GTEST<__GUNIT_CAT(GTEST_TYPE_, __LINE__), NAME>::TestBodyImpl(         \
-      ::testing::detail::TestRun& tr_gtest __attribute__((unused)))
+      RUNNER& tr_gtest __attribute__((unused)))
 
-#define __GTEST_IMPL_1(DISABLED, TYPE)                      \
-  __GTEST_IMPL(DISABLED, TYPE, ::testing::detail::string<>, \
+#define __GTEST_IMPL_1(RUNNER, DISABLED, TYPE)                      \
+  __GTEST_IMPL(RUNNER, DISABLED, TYPE, ::testing::detail::string<>, \
                ::testing::detail::type<void>{}, )
-#define __GTEST_IMPL_2(DISABLED, TYPE, NAME)                           \
-  using __GUNIT_CAT(GTEST_TEST_NAME, __LINE__) =                       \
-      decltype(__GUNIT_CAT(NAME, _gtest_string));                      \
-  __GTEST_IMPL(DISABLED, TYPE, __GUNIT_CAT(GTEST_TEST_NAME, __LINE__), \
+#define __GTEST_IMPL_2(RUNNER, DISABLED, TYPE, NAME)                           \
+  using __GUNIT_CAT(GTEST_TEST_NAME, __LINE__) =                               \
+      decltype(__GUNIT_CAT(NAME, _gtest_string));                              \
+  __GTEST_IMPL(RUNNER, DISABLED, TYPE, __GUNIT_CAT(GTEST_TEST_NAME, __LINE__), \
                ::testing::detail::type<void>{}, )
 
-#define __GTEST_IMPL_3(DISABLED, TYPE, NAME, PARAMS)                           \
+#define __GTEST_IMPL_3(RUNNER, DISABLED, TYPE, NAME, PARAMS)                   \
   using __GUNIT_CAT(GTEST_TEST_NAME, __LINE__) =                               \
       decltype(__GUNIT_CAT(NAME, _gtest_string));                              \
   static ::testing::internal::ParamGenerator<                                  \
@@ -298,14 +854,33 @@ class GTest : public detail::GTest<T, TParamType> {};
         ::testing::detail::apply_t<std::common_type_t, decltype(PARAMS)>>()(   \
         info);                                                                 \
   }                                                                            \
-  __GTEST_IMPL(DISABLED, TYPE, __GUNIT_CAT(GTEST_TEST_NAME, __LINE__), PARAMS, \
+  __GTEST_IMPL(RUNNER, DISABLED, TYPE,                                         \
+               __GUNIT_CAT(GTEST_TEST_NAME, __LINE__), PARAMS,                 \
                &__GUNIT_CAT(GTEST_EVAL, __LINE__),                             \
                &__GUNIT_CAT(GTEST_GENERATE_NAMES, __LINE__))
 
-#define GTEST(...) \
-  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__))(false, __VA_ARGS__) // NOLINT
-#define DISABLED_GTEST(...) \
-  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__))(true, __VA_ARGS__) // NOLINT
+#define GTEST(...)                                      \
+  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__)) \
+  (::testing::detail::TestRun, false, __VA_ARGS__)  // NOLINT
+#define DISABLED_GTEST(...)                             \
+  __GUNIT_CAT(__GTEST_IMPL_, __GUNIT_SIZE(__VA_ARGS__)) \
+  (::testing::detail::TestRun, true, __VA_ARGS__)  // NOLINT
+
+#define __GTEST_LAZY_IMPL(DISABLED, TYPE, NAME, ...)                         \
+  static auto __GUNIT_CAT(GTEST_SOURCE, __LINE__)() { return __VA_ARGS__; }  \
+  using __GUNIT_CAT(GTEST_TEST_NAME, __LINE__) =                             \
+      decltype(__GUNIT_CAT(NAME, _gtest_string));                            \
+  __GTEST_IMPL(                                                              \
+      ::testing::detail::LazyParamRun<&__GUNIT_CAT(GTEST_SOURCE, __LINE__)>, \
+      DISABLED, TYPE, __GUNIT_CAT(GTEST_TEST_NAME, __LINE__),                \
+      ::testing::detail::type<void>{}, )
+
+#define GTEST_LAZY(TYPE, NAME, ...) \
+  __GTEST_LAZY_IMPL(false, TYPE, NAME, __VA_ARGS__)  // NOLINT
+#define DISABLED_GTEST_LAZY(TYPE, NAME, ...) \
+  __GTEST_LAZY_IMPL(true, TYPE, NAME, __VA_ARGS__)  // NOLINT
+
+#define LAZY_PARAM tr_gtest.param()
 
 #define SHOULD(NAME) if (tr_gtest.run("SHOULD", NAME, __LINE__))
 #define DISABLED_SHOULD(NAME) if (tr_gtest.run("SHOULD", NAME, __LINE__, true))
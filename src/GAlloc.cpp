@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Replaces the global operator new/delete to count allocations per thread
+// (`gunit_alloc` target), see GUnit/Detail/AllocUtils.h
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace {
+thread_local std::uint64_t allocations{};
+thread_local std::uint64_t allocated_bytes{};
+thread_local int ignored{};
+
+void* allocate(std::size_t size) {
+  if (!ignored) {
+    ++allocations;
+    allocated_bytes += size;
+  }
+  for (;;) {
+    if (auto* ptr = std::malloc(size ? size : 1)) {
+      return ptr;
+    }
+    const auto handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc{};
+    }
+    handler();
+  }
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment) {
+  const auto align =
+      std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+  if (!ignored) {
+    ++allocations;
+    allocated_bytes += size;
+  }
+  for (;;) {
+#if defined(_WIN32)
+    if (auto* ptr = _aligned_malloc(size ? size : 1, align)) {
+      return ptr;
+    }
+#else
+    void* ptr{};
+    if (!posix_memalign(&ptr, align, size ? size : 1)) {
+      return ptr;
+    }
+#endif
+    const auto handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc{};
+    }
+    handler();
+  }
+}
+
+void deallocate(void* ptr) noexcept { std::free(ptr); }
+
+void deallocate(void* ptr, std::align_val_t) noexcept {
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+}  // namespace
+
+extern "C" std::uint64_t gunit_allocations() { return allocations; }
+extern "C" std::uint64_t gunit_allocated_bytes() { return allocated_bytes; }
+extern "C" void gunit_ignore_allocations(bool ignore) {
+  ignored += ignore ? 1 : -1;
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return allocate(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocate(size, alignment);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete(void* ptr, std::size_t,
+                     std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void* ptr, std::size_t,
+                       std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete(void* ptr, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void* ptr, std::align_val_t alignment,
+                       const std::nothrow_t&) noexcept {
+  deallocate(ptr, alignment);
+}
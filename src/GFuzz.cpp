@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Coverage callbacks of `-fsanitize-coverage=trace-pc-guard` (clang) and
+// `-fsanitize-coverage=trace-pc` (gcc) guiding GFUZZ (`gunit_fuzz` target),
+// see GUnit/Detail/FuzzUtils.h
+//
+// This file must not be compiled with coverage instrumentation.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr std::size_t size = 1u << 16;
+alignas(std::uint64_t) std::uint8_t counters[size];
+bool tracing{};  // only while a GFUZZ body runs
+
+/**
+ * @return hit count bucket (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+) bit
+ */
+std::uint8_t bucket(std::uint8_t count) {
+  if (count < 4) {
+    return std::uint8_t(1u << (count - 1));
+  }
+  if (count < 8) {
+    return 1u << 3;
+  }
+  if (count < 16) {
+    return 1u << 4;
+  }
+  if (count < 32) {
+    return 1u << 5;
+  }
+  return count < 128 ? 1u << 6 : 1u << 7;
+}
+}  // namespace
+
+extern "C" std::size_t gunit_coverage_size() { return size; }
+
+extern "C" void gunit_coverage_start() {
+  std::memset(counters, 0, size);
+  tracing = true;
+}
+
+extern "C" std::size_t gunit_coverage_stop(std::uint8_t* seen) {
+  tracing = false;
+  std::size_t features{};
+  for (std::size_t i{}; i < size; i += sizeof(std::uint64_t)) {
+    std::uint64_t word{};
+    std::memcpy(&word, counters + i, sizeof(word));
+    if (!word) {
+      continue;
+    }
+    for (auto j = i; j < i + sizeof(word); ++j) {
+      if (counters[j]) {
+        const auto b = bucket(counters[j]);
+        if (!(seen[j] & b)) {
+          seen[j] |= b;
+          ++features;
+        }
+      }
+    }
+  }
+  return features;
+}
+
+extern "C" void __sanitizer_cov_trace_pc_guard_init(std::uint32_t* start,
+                                                    std::uint32_t* stop) {
+  static std::uint32_t guards{};
+  if (start == stop || *start) {
+    return;
+  }
+  for (auto guard = start; guard < stop; ++guard) {
+    *guard = ++guards;
+  }
+}
+
+extern "C" void __sanitizer_cov_trace_pc_guard(std::uint32_t* guard) {
+  if (tracing) {
+    ++counters[*guard % size];
+  }
+}
+
+extern "C" void __sanitizer_cov_trace_pc() {
+  if (tracing) {
+    const auto pc =
+        reinterpret_cast<std::uintptr_t>(__builtin_return_address(0));
+    ++counters[(pc ^ (pc >> 16)) % size];
+  }
+}
@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Converts `--gunit_journal` files (`gunit_journal` target) to reports
+//
+//   gunit_journal [--xml=<file>] [--json=<file>] <journal>...
+//
+// Journals of several shards are merged, XML is written to stdout if no
+// output is given, see GUnit/Detail/JournalUtils.h
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/JournalUtils.h"
+
+int main(int argc, char** argv) {
+  std::string xml{}, json{};
+  std::vector<std::string> journals{};
+  for (auto i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+    if (arg.find("--xml=") == 0) {
+      xml = arg.substr(6);
+    } else if (arg.find("--json=") == 0) {
+      json = arg.substr(7);
+    } else {
+      journals.push_back(arg);
+    }
+  }
+  if (journals.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--xml=<file>] [--json=<file>] <journal>..." << std::endl;
+    return 1;
+  }
+
+  const testing::detail::journal_report report{journals};
+  if (report.dropped()) {
+    std::cerr << report.dropped()
+              << " records didn't fit into the journals" << std::endl;
+  }
+  if (!xml.empty()) {
+    std::ofstream out{xml};
+    report.write_xml(out);
+  }
+  if (!json.empty()) {
+    std::ofstream out{json};
+    report.write_json(out);
+  }
+  if (xml.empty() && json.empty()) {
+    report.write_xml(std::cout);
+  }
+  return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "GUnit/Detail/AllocUtils.h"
+#include "GUnit/Detail/StatsUtils.h"
+#include "GUnit/GAssert.h"
+#include "GUnit/GBench.h"
+#include "GUnit/GMock.h"
+
+struct interface {
+  virtual ~interface() = default;
+  virtual int get(int) const = 0;
+};
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(AllocUtils, ShouldCountAllocationsOfTheCurrentThread) {
+  ASSERT_TRUE(has_allocations());
+  const auto allocations = detail::allocations();
+  const auto bytes = allocated_bytes();
+  auto ptr = std::make_unique<std::uint64_t>(42);
+  EXPECT_EQ(allocations + 1, detail::allocations());
+  EXPECT_EQ(bytes + sizeof(std::uint64_t), allocated_bytes());
+
+  std::uint64_t thread_allocations{};
+  std::thread{[&thread_allocations] {
+    const auto allocations = detail::allocations();
+    DoNotOptimize(std::vector<int>(100));
+    thread_allocations = detail::allocations() - allocations;
+  }}.join();
+  EXPECT_EQ(1u, thread_allocations);
+}
+
+TEST(AllocUtils, ShouldIgnoreAllocations) {
+  const auto allocations = detail::allocations();
+  {
+    const ignore_allocations outer{};
+    {
+      const ignore_allocations inner{};
+      DoNotOptimize(std::make_unique<int>(0));
+    }
+    DoNotOptimize(std::make_unique<int>(0));
+  }
+  EXPECT_EQ(allocations, detail::allocations());
+  DoNotOptimize(std::make_unique<int>(0));
+  EXPECT_EQ(allocations + 1, detail::allocations());
+}
+
+TEST(AllocUtils, ShouldCountAllocationsInSectionStats) {
+  const auto start = current_usage();
+  DoNotOptimize(std::vector<char>(1024));
+  const auto s = make_section_stats("test", "should", start, current_usage());
+  EXPECT_EQ(1u, s.allocations);
+  EXPECT_EQ(1024u, s.allocated_bytes);
+}
+
+TEST(AllocUtils, ShouldExpectNoAllocations) {
+  auto i = 0;
+  EXPECT_NO_ALLOCATIONS { ++i; }
+  EXPECT_EQ(1, i);
+
+  EXPECT_NONFATAL_FAILURE(EXPECT_NO_ALLOCATIONS { DoNotOptimize(std::make_unique<int>(i)); },
+                          "Expected at most 0 allocation(s)");
+}
+
+TEST(AllocUtils, ShouldExpectAllocationsAtMost) {
+  EXPECT_ALLOCATIONS_AT_MOST(1) { DoNotOptimize(std::make_unique<int>(0)); }
+
+  EXPECT_NONFATAL_FAILURE(
+      EXPECT_ALLOCATIONS_AT_MOST(1) {
+        DoNotOptimize(std::make_unique<int>(0));
+        DoNotOptimize(std::make_unique<int>(0));
+      },
+      "Actual: 2 allocation(s), 8 bytes");
+}
+
+TEST(AllocUtils, ShouldNotAllocateInPassedAssertions) {
+  const auto i = 42;
+  const std::string str{"a string which doesn't fit into the small buffer"};
+  EXPECT_NO_ALLOCATIONS {
+    EXPECT(i == 42) << "message " << i;
+    EXPECT(str == "a string which doesn't fit into the small buffer" and
+           i != 0 and i > 0 and i >= 0 and i <= 42 and i < 100);
+    EXPECT(std::string_view{"a string which doesn't fit"} ==
+           "a string which doesn't fit");
+    ASSERT(i == 42) << "message";
+  }
+}
+
+TEST(AllocUtils, ShouldNotCountMockAllocations) {
+  GMock<interface> mock{};
+  EXPECT_CALL(mock, (get)(42)).WillOnce(Return(7));
+
+  auto result = 0;
+  EXPECT_NO_ALLOCATIONS { result = mock.object().get(42); }
+  EXPECT_EQ(7, result);
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
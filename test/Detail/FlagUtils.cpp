@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "GUnit/Detail/FlagUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(FlagUtils, ShouldReturnEmptyFlagWhenNotSet) {
+  EXPECT_EQ(std::string{}, flag("not_set"));
+  EXPECT_FALSE(is_flag_enabled("not_set"));
+}
+
+TEST(FlagUtils, ShouldReadFlagFromEnvironment) {
+  setenv("GUNIT_TEST_FLAG", "42", 1);
+  EXPECT_EQ(std::string{"42"}, flag("test_flag"));
+  EXPECT_TRUE(is_flag_enabled("test_flag"));
+
+  setenv("GUNIT_TEST_FLAG", "0", 1);
+  EXPECT_FALSE(is_flag_enabled("test_flag"));
+
+  setenv("GUNIT_TEST_FLAG", "false", 1);
+  EXPECT_FALSE(is_flag_enabled("test_flag"));
+  unsetenv("GUNIT_TEST_FLAG");
+}
+
+}  // detail
+}  // v1
+}  // testing
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "GUnit/Detail/FuzzUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(FuzzUtils, ShouldRunAllRunsWhenNothingFails) {
+  fuzz_options options{};
+  options.runs = 1000;
+  auto calls = 0u;
+  fuzzer f{options, [&calls](const bytes&) { return ++calls, false; }};
+  const auto result = f.run();
+  EXPECT_FALSE(result.failed);
+  EXPECT_EQ(1000u, result.runs);
+  EXPECT_EQ(1000u, calls);
+}
+
+TEST(FuzzUtils, ShouldKeepInputsWithinMaxSize) {
+  fuzz_options options{};
+  options.runs = 10000;
+  options.max_size = 8;
+  std::size_t max{};
+  fuzzer f{options, [&max](const bytes& input) {
+             max = std::max(max, input.size());
+             return false;
+           }};
+  f.run();
+  EXPECT_TRUE(max > 0u);
+  EXPECT_TRUE(max <= 8u);
+}
+
+TEST(FuzzUtils, ShouldFindAndMinimizeFailingInput) {
+  fuzz_options options{};
+  options.runs = 100000;
+  options.seed = 42;
+  fuzzer f{options, [](const bytes& input) {
+             return std::count(input.begin(), input.end(), 0xff) >= 2;
+           }};
+  const auto result = f.run();
+  ASSERT_TRUE(result.failed);
+  EXPECT_TRUE(result.runs < 100000u);
+  EXPECT_EQ((bytes{0xff, 0xff}), result.input);
+  EXPECT_TRUE(result.original_size >= 2u);
+}
+
+TEST(FuzzUtils, ShouldMinimizeFixedSizeInputsWithoutChangingTheirSize) {
+  fuzz_options options{};
+  options.runs = 100000;
+  options.fixed_size = sizeof(std::uint32_t);
+  fuzzer f{options, [](const bytes& input) {
+             EXPECT_EQ(sizeof(std::uint32_t), input.size());
+             return input[1] > 0x10;
+           }};
+  const auto result = f.run();
+  ASSERT_TRUE(result.failed);
+  ASSERT_EQ(sizeof(std::uint32_t), result.input.size());
+  EXPECT_EQ(0u, result.input[0]);
+  EXPECT_TRUE(result.input[1] > 0x10);
+  EXPECT_EQ(0u, result.input[2]);
+  EXPECT_EQ(0u, result.input[3]);
+}
+
+TEST(FuzzUtils, ShouldStartWithFailingInputSavedInCorpus) {
+  const auto corpus = std::string{::testing::TempDir()} + "FuzzUtilsCorpus";
+  std::filesystem::remove_all(corpus);
+  const auto failed = [](const bytes& input) {
+    return std::find(input.begin(), input.end(), 'x') != input.end();
+  };
+
+  fuzz_options options{};
+  options.runs = 1000000;
+  options.corpus = corpus;
+  fuzzer first{options, failed};
+  const auto found = first.run();
+  ASSERT_TRUE(found.failed);
+  EXPECT_EQ(bytes{'x'}, found.input);
+
+  options.seed = 1;
+  fuzzer second{options, failed};
+  const auto result = second.run();
+  ASSERT_TRUE(result.failed);
+  EXPECT_EQ(found.input, result.input);
+  EXPECT_TRUE(result.runs < found.runs);
+  std::filesystem::remove_all(corpus);
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
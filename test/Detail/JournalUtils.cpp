@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gmock/gmock.h>  // HasSubstr
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/JournalUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+#if GUNIT_HAS_FORK
+TEST(JournalUtils, ShouldReadAppendedRecords) {
+  const auto file = std::string{::testing::TempDir()} + "JournalUtils.journal";
+  {
+    result_journal journal{file};
+    ASSERT_TRUE(journal.is_enabled());
+    journal.append(journal_kind::START, journal_status::PASSED, 0, "A.b");
+    journal.append(journal_kind::SECTION, journal_status::FAILED, 42, "A.b",
+                   "should do");
+    journal.append(journal_kind::TEST, journal_status::FAILED, 100, "A.b");
+  }
+
+  const journal_reader reader{file};
+  ASSERT_TRUE(reader.is_open());
+  std::vector<journal_reader::entry> entries{};
+  reader.for_each(
+      [&entries](const journal_reader::entry& e) { entries.push_back(e); });
+  ASSERT_EQ(3u, entries.size());
+  EXPECT_EQ(journal_kind::START, entries[0].kind);
+  EXPECT_EQ("A.b", entries[0].test);
+  EXPECT_EQ(journal_kind::SECTION, entries[1].kind);
+  EXPECT_EQ(journal_status::FAILED, entries[1].status);
+  EXPECT_EQ(42u, entries[1].us);
+  EXPECT_EQ("should do", entries[1].detail);
+  EXPECT_EQ(journal_kind::TEST, entries[2].kind);
+  EXPECT_EQ(100u, entries[2].us);
+  EXPECT_EQ(0u, reader.dropped());
+  std::remove(file.c_str());
+}
+
+TEST(JournalUtils, ShouldKeepRecordsOfCrashedProcesses) {
+  const auto file = std::string{::testing::TempDir()} + "JournalUtils.journal";
+  const auto pid = ::fork();
+  ASSERT_LE(0, pid);
+  if (!pid) {
+    const auto journal = new result_journal{file};  // never unmapped
+    journal->append(journal_kind::START, journal_status::PASSED, 0, "A.ok");
+    journal->append(journal_kind::TEST, journal_status::PASSED, 1, "A.ok");
+    journal->append(journal_kind::START, journal_status::PASSED, 0, "A.crash");
+    journal->append(journal_kind::FAILURE, journal_status::FAILED, 0,
+                    "A.crash", "file.cpp:1\nfailed");
+    ::_exit(0);
+  }
+  int status{};
+  ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+
+  std::ostringstream xml{};
+  journal_report{{file}}.write_xml(xml);
+  EXPECT_THAT(xml.str(), HasSubstr("<testsuite name=\"A\" tests=\"2\" "
+                                   "failures=\"1\""));
+  EXPECT_THAT(xml.str(), HasSubstr("<testcase name=\"ok\" status=\"run\" "
+                                   "result=\"completed\" time=\"0.000\" "
+                                   "classname=\"A\" />"));
+  EXPECT_THAT(xml.str(),
+              HasSubstr("<failure message=\"file.cpp:1&#x0A;failed\""));
+  EXPECT_THAT(xml.str(), HasSubstr("the test binary crashed"));
+  std::remove(file.c_str());
+}
+
+TEST(JournalUtils, ShouldMergeShardsIntoJsonReport) {
+  const auto tmp = std::string{::testing::TempDir()};
+  const std::vector<std::string> files{tmp + "JournalUtils.0.journal",
+                                       tmp + "JournalUtils.1.journal"};
+  {
+    result_journal shard0{files[0]}, shard1{files[1]};
+    shard0.append(journal_kind::START, journal_status::PASSED, 0, "A.b");
+    shard0.append(journal_kind::STEP, journal_status::PASSED, 3, "A.b",
+                  "Given \"x\"");
+    shard0.append(journal_kind::TEST, journal_status::PASSED, 2000, "A.b");
+    shard1.append(journal_kind::START, journal_status::PASSED, 0, "B.c");
+    shard1.append(journal_kind::TEST, journal_status::SKIPPED, 0, "B.c");
+  }
+
+  std::ostringstream json{};
+  journal_report{files}.write_json(json);
+  EXPECT_THAT(json.str(), HasSubstr("\"tests\": 2,\n  \"failures\": 0"));
+  EXPECT_THAT(json.str(), HasSubstr("\"name\": \"b\",\n          \"status\": "
+                                    "\"RUN\",\n          \"result\": "
+                                    "\"COMPLETED\",\n          \"time\": "
+                                    "\"0.002s\""));
+  EXPECT_THAT(json.str(), HasSubstr("\"name\": \"Given \\\"x\\\"\",\n"
+                                    "              \"type\": \"STEP\""));
+  EXPECT_THAT(json.str(), HasSubstr("\"result\": \"SKIPPED\""));
+  for (const auto& file : files) {
+    std::remove(file.c_str());
+  }
+}
+
+TEST(JournalUtils, ShouldDropRecordsExceedingTheCapacity) {
+  const auto file = std::string{::testing::TempDir()} + "JournalUtils.journal";
+  {
+    result_journal journal{file, 64};
+    journal.append(journal_kind::START, journal_status::PASSED, 0, "A.b");
+    journal.append(journal_kind::START, journal_status::PASSED, 0, "A.c");
+    journal.append(journal_kind::START, journal_status::PASSED, 0, "A.d");
+  }
+
+  const journal_reader reader{file};
+  auto entries = 0;
+  reader.for_each([&entries](const journal_reader::entry&) { ++entries; });
+  EXPECT_EQ(1, entries);
+  EXPECT_EQ(2u, reader.dropped());
+  std::remove(file.c_str());
+}
+#endif
+
+TEST(JournalUtils, ShouldBeDisabledWithoutFile) {
+  result_journal journal{""};
+  EXPECT_FALSE(journal.is_enabled());
+  journal.append(journal_kind::START, journal_status::PASSED, 0, "A.b");
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "GUnit/Detail/ProcUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(ProcUtils, ShouldInterceptResultsOfAllThreads) {
+  std::vector<std::string> messages{};
+  {
+    intercept_results intercept{[&](const TestPartResult& result) {
+      messages.push_back(result.message());
+    }};
+    ADD_FAILURE() << "current thread";
+    std::thread{[] { ADD_FAILURE() << "other thread"; }}.join();
+  }
+  const std::vector<std::string> expected = {"Failed\ncurrent thread",
+                                            "Failed\nother thread"};
+  EXPECT_EQ(expected, messages);
+}
+
+#if GUNIT_HAS_FORK
+TEST(ProcUtils, ShouldSerializeTestPartResults) {
+  int fds[2] = {};
+  ASSERT_EQ(0, ::pipe(fds));
+  write_result(fds[1], TestPartResult{TestPartResult::kNonFatalFailure,
+                                      "file.cpp", 42, "message"});
+  write_result(fds[1], TestPartResult{TestPartResult::kFatalFailure, nullptr,
+                                      -1, ""});
+  ::close(fds[1]);
+
+  const auto first = read_result(fds[0]);
+  ASSERT_TRUE(first != nullptr);
+  EXPECT_EQ(TestPartResult::kNonFatalFailure, first->type());
+  EXPECT_STREQ("file.cpp", first->file_name());
+  EXPECT_EQ(42, first->line_number());
+  EXPECT_STREQ("message", first->message());
+
+  const auto second = read_result(fds[0]);
+  ASSERT_TRUE(second != nullptr);
+  EXPECT_EQ(TestPartResult::kFatalFailure, second->type());
+  EXPECT_EQ(nullptr, second->file_name());
+  EXPECT_EQ(-1, second->line_number());
+  EXPECT_STREQ("", second->message());
+
+  EXPECT_TRUE(read_result(fds[0]) == nullptr);
+  ::close(fds[0]);
+}
+
+TEST(ProcUtils, ShouldReportChildProcessResultsInParent) {
+  std::vector<std::string> messages{};
+  {
+    intercept_results intercept{[&](const TestPartResult& result) {
+      messages.push_back(result.message());
+    }};
+    child_process child{};
+    if (child.fork("child")) {
+      ADD_FAILURE() << "from child";
+      child.finish();
+    }
+    EXPECT_FALSE(child.is_child());
+  }
+  const std::vector<std::string> expected = {"Failed\nfrom child"};
+  EXPECT_EQ(expected, messages);
+}
+#endif
+
+}  // detail
+}  // v1
+}  // testing
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gmock/gmock.h>  // HasSubstr
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/RangeUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(RangeUtils, ShouldFindFirstMismatch) {
+  std::vector<std::uint8_t> lhs(1000, 42), rhs(1000, 42);
+  EXPECT_EQ(0u, mismatch(lhs.data(), rhs.data(), 0));
+  EXPECT_EQ(lhs.size(), mismatch(lhs.data(), rhs.data(), lhs.size()));
+
+  for (auto i : {0u, 1u, 7u, 8u, 15u, 16u, 31u, 32u, 33u, 500u, 999u}) {
+    rhs[i] = 0;
+    EXPECT_EQ(i, mismatch(lhs.data(), rhs.data(), lhs.size()));
+    EXPECT_EQ(i, mismatch(lhs.data(), rhs.data(), i));
+    EXPECT_EQ(i, scalar_mismatch(lhs.data(), rhs.data(), lhs.size()));
+    if (i) {  // unaligned
+      EXPECT_EQ(i - 1, mismatch(lhs.data() + 1, rhs.data() + 1, i));
+    }
+    rhs[i] = 42;
+  }
+}
+
+TEST(RangeUtils, ShouldCompareEqualRanges) {
+  const std::vector<int> v{1, 2, 3};
+  const int a[] = {1, 2, 3};
+  const std::list<int> l{1, 2, 3};
+  EXPECT_TRUE(range_eq("v", "a", v, a));
+  EXPECT_TRUE(range_eq("v", "l", v, l));
+  EXPECT_TRUE(range_eq("d", "d", std::vector<double>{.5}, std::array{.5}));
+  EXPECT_TRUE(range_eq("e", "e", std::vector<int>{}, std::array<int, 0>{}));
+}
+
+TEST(RangeUtils, ShouldReportFirstMismatchWithItsNeighbourhood) {
+  std::vector<int> actual(100), expected(100);
+  actual[42] = 7;
+  const auto result = range_eq("actual", "expected", actual, expected);
+  ASSERT_FALSE(result);
+  EXPECT_THAT(result.message(), HasSubstr("First mismatch at index 42:\n"));
+  EXPECT_THAT(
+      result.message(),
+      HasSubstr("  actual[34..51):   0 0 0 0 0 0 0 0 7 0 0 0 0 0 0 0 0\n"
+                "  expected[34..51): 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n"
+                "                                    ^"));
+}
+
+TEST(RangeUtils, ShouldReportRangesOfDifferentSizes) {
+  const std::list<std::string> actual{"a", "b"};
+  const std::vector<std::string> expected{"a", "b", "c"};
+  const auto result = range_eq("actual", "expected", actual, expected);
+  ASSERT_FALSE(result);
+  EXPECT_THAT(result.message(), HasSubstr("Which is: 2 element(s)"));
+  EXPECT_THAT(result.message(), HasSubstr("Which is: 3 element(s)"));
+  EXPECT_THAT(result.message(),
+              HasSubstr("Ranges differ in size from index 2:\n"));
+  EXPECT_THAT(result.message(), HasSubstr("expected[0..3): \"a\" \"b\" \"c\""));
+}
+
+TEST(RangeUtils, ShouldReportBytesAsHex) {
+  const std::uint8_t lhs[] = {0x00, 0x01, 0xfe, 0xff};
+  const std::uint8_t rhs[] = {0x00, 0x01, 0xfe, 0x0f};
+  EXPECT_TRUE(bytes_eq("lhs", "rhs", "3", lhs, rhs, 3));
+  const auto result = bytes_eq("lhs", "rhs", "4", lhs, rhs, 4);
+  ASSERT_FALSE(result);
+  EXPECT_THAT(result.message(), HasSubstr("First mismatch at byte 3 of 4:\n"
+                                          "  lhs[0..4): 00 01 fe ff\n"
+                                          "  rhs[0..4): 00 01 fe 0f\n"
+                                          "                      ^^"));
+}
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -112,6 +112,47 @@ TEST(RegexUtils, ShouldReturnMatches) {
   EXPECT_EQ(0u, matches(n10, t11).size());
 }
 
+TEST(RegexUtils, ShouldMatchPatterns) {
+  EXPECT_TRUE(PatternMatchesString("", ""));
+  EXPECT_FALSE(PatternMatchesString("", "a"));
+  EXPECT_TRUE(PatternMatchesString("*", ""));
+  EXPECT_TRUE(PatternMatchesString("*", "abc"));
+  EXPECT_TRUE(PatternMatchesString("a?c", "abc"));
+  EXPECT_FALSE(PatternMatchesString("a?c", "ac"));
+  EXPECT_TRUE(PatternMatchesString("a*c", "abbbc"));
+  EXPECT_TRUE(PatternMatchesString("*bc*", "abcbcd"));
+  EXPECT_FALSE(PatternMatchesString("*bd*", "abcbc"));
+  EXPECT_TRUE(PatternMatchesString("a*:b", "abc"));
+  EXPECT_FALSE(PatternMatchesString("a:*", "abc"));
+}
+
+TEST(RegexUtils, ShouldMatchPatternsWithManyStarsInLinearTime) {
+  const std::string name(10'000, 'a');
+  EXPECT_FALSE(PatternMatchesString(
+      "*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*b", name.c_str()));
+  EXPECT_TRUE(PatternMatchesString("*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a",
+                                   name.c_str()));
+}
+
+TEST(RegexUtils, ShouldMatchFilter) {
+  EXPECT_TRUE(filter{}("anything"));
+  EXPECT_TRUE(filter{"*"}(""));
+
+  const filter f{"return*:exact-*fail*:*skip"};
+  EXPECT_TRUE(f("return value"));
+  EXPECT_TRUE(f("exact"));
+  EXPECT_FALSE(f("exactly"));
+  EXPECT_FALSE(f("return failure"));
+  EXPECT_FALSE(f("return and skip"));
+  EXPECT_FALSE(f("other"));
+
+  EXPECT_TRUE(filter{"-a*"}("b"));
+  EXPECT_FALSE(filter{"-a*"}("ab"));
+
+  EXPECT_TRUE(FilterMatchesShould("return value", "return*"));
+  EXPECT_FALSE(FilterMatchesShould("return value", "*-return*"));
+}
+
 }  // detail
 }  // v1
 }  // testing
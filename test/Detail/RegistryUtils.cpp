@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GUnit/Detail/RegistryUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+namespace {
+struct registered {
+  std::string name{};
+  bool matched{};
+#if GUNIT_HAS_FORK
+  pid_t pid = ::getpid();
+#endif
+};
+
+std::vector<registered>& calls() {
+  static std::vector<registered> c{};
+  return c;
+}
+
+void register_test(void* self, const filter& f) {
+  calls().push_back({static_cast<const char*>(self),
+                     f("RegistryUtils.ShouldRegisterEntriesInOrder")});
+}
+
+char first[] = "first";
+char second[] = "second";
+lazy_registry::entry first_entry{&register_test, first};
+lazy_registry::entry second_entry{&register_test, second};
+const auto added = (lazy_registry::add(first_entry),
+                    lazy_registry::add(second_entry), true);
+}  // namespace
+
+TEST(RegistryUtils, ShouldRegisterEntriesInOrder) {
+  ASSERT_EQ(2u, calls().size());
+  EXPECT_EQ("first", calls()[0].name);
+  EXPECT_EQ("second", calls()[1].name);
+  EXPECT_TRUE(calls()[0].matched);  // the filter selected this test
+  EXPECT_TRUE(calls()[1].matched);
+}
+
+TEST(RegistryUtils, ShouldRegisterLateEntriesImmediately) {
+  calls().clear();
+  char late[] = "late";
+  lazy_registry::entry entry{&register_test, late};
+  lazy_registry::add(entry);
+  ASSERT_EQ(1u, calls().size());
+  EXPECT_EQ("late", calls()[0].name);
+}
+
+#if GUNIT_HAS_FORK && defined(__linux__)
+namespace {
+std::string request(const std::string& path, const std::string& line) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  for (auto retry = 0; retry < 500; ++retry) {  // until the server listens
+    const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                  sizeof(address))) {
+      ::close(fd);
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      continue;
+    }
+    const auto data = line + '\n';
+    write_all(fd, data.data(), data.size());
+    std::string response{};
+    char buffer[256];
+    for (ssize_t n{}; (n = ::read(fd, buffer, sizeof(buffer))) > 0;) {
+      response.append(buffer, std::size_t(n));
+    }
+    ::close(fd);
+    return response;
+  }
+  return "can't connect";
+}
+}  // namespace
+
+TEST(RegistryUtils, ShouldRegisterEntriesBeforeServing) {
+  if (!flag("server").empty()) {  // run by a child of the server
+    ASSERT_FALSE(calls().empty());
+    EXPECT_EQ(::getppid(), calls()[0].pid);
+    return;
+  }
+
+  const auto path = "/tmp/gunit_registry_" + std::to_string(::getpid());
+  const auto pid = ::fork();
+  ASSERT_NE(-1, pid);
+  if (!pid) {
+    ::setenv("GUNIT_SERVER", path.c_str(), 1);
+    (void)std::freopen("/dev/null", "w", stdout);
+    ::execl("/proc/self/exe", "RegistryUtils", static_cast<char*>(nullptr));
+    ::_exit(1);
+  }
+  const auto response =
+      request(path, "RegistryUtils.ShouldRegisterEntriesBeforeServing");
+  request(path, "quit");
+  ::waitpid(pid, nullptr, 0);
+  EXPECT_NE(std::string::npos,
+            response.find("PASSED RegistryUtils.ShouldRegisterEntriesBefore"))
+      << response;
+}
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "GUnit/Detail/RunnerUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(RunnerUtils, ShouldRunTestsInTheCallerWhenJobsAreNotSet) {
+  jobs_runner runner{};
+  auto calls = 0;
+  runner.add(UnitTest::GetInstance()->current_test_info(), [&] { ++calls; });
+  runner.OnEnvironmentsSetUpEnd(*UnitTest::GetInstance());
+  EXPECT_FALSE(runner.is_worker());
+  EXPECT_FALSE(runner.replay());
+  runner.OnEnvironmentsTearDownStart(*UnitTest::GetInstance());
+  EXPECT_EQ(0, calls);
+}
+
+#if GUNIT_HAS_FORK
+void fail_fatally() { FAIL() << "helper"; }
+
+TEST(RunnerUtils, ShouldReportResultsAndPropertiesOfTestsRunByWorkers) {
+  jobs_runner runner{};
+  runner.add(UnitTest::GetInstance()->current_test_info(), [] {
+    fail_fatally();
+    Test::RecordProperty("fatal", Test::HasFatalFailure() ? "yes" : "no");
+  });
+  ::setenv("GUNIT_JOBS", "2", 1);
+  runner.OnEnvironmentsSetUpEnd(*UnitTest::GetInstance());
+  ::unsetenv("GUNIT_JOBS");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));  // claimed
+
+  TestPartResultArray results{};
+  auto replayed = false;
+  {
+    ScopedFakeTestPartResultReporter reporter{&results};
+    replayed = runner.replay();
+  }
+  runner.OnEnvironmentsTearDownStart(*UnitTest::GetInstance());
+
+  ASSERT_TRUE(replayed);
+  ASSERT_EQ(1, results.size());
+  EXPECT_TRUE(results.GetTestPartResult(0).fatally_failed());
+  EXPECT_STREQ("Failed\nhelper", results.GetTestPartResult(0).message());
+  const auto& result = *UnitTest::GetInstance()->current_test_info()->result();
+  ASSERT_EQ(1, result.test_property_count());
+  EXPECT_STREQ("fatal", result.GetTestProperty(0).key());
+  EXPECT_STREQ("yes", result.GetTestProperty(0).value());
+}
+#endif
+
+TEST(RunnerUtils, ShouldParseFormattedTimings) {
+  std::string name{};
+  timings_journal::entry e{};
+  EXPECT_TRUE(timings_journal::parse(
+      timings_journal::format("suite.test/should do", {42, true}), name, e));
+  EXPECT_EQ(std::string{"suite.test/should do"}, name);
+  EXPECT_EQ(42u, e.us);
+  EXPECT_TRUE(e.failed);
+
+  EXPECT_FALSE(timings_journal::parse("", name, e));
+  EXPECT_FALSE(timings_journal::parse("42", name, e));
+  EXPECT_FALSE(timings_journal::parse("x 0 name", name, e));
+}
+
+TEST(RunnerUtils, ShouldOrderFailedNewAndLongestTimingsFirst) {
+  const auto file = std::string{::testing::TempDir()} + "RunnerUtils.timings";
+  {
+    timings_journal journal{file};
+    journal.record("short", {1, false});
+    journal.record("long", {100, false});
+    journal.record("failed", {1, true});
+    journal.save();
+  }
+
+  timings_journal journal{file};
+  ASSERT_TRUE(journal.find("long"));
+  EXPECT_EQ(100u, journal.find("long")->us);
+  EXPECT_FALSE(journal.find("new"));
+
+  EXPECT_TRUE(journal.before("failed", "new"));
+  EXPECT_TRUE(journal.before("new", "long"));
+  EXPECT_TRUE(journal.before("long", "short"));
+  EXPECT_FALSE(journal.before("short", "long"));
+  EXPECT_FALSE(journal.before("long", "long"));
+  std::remove(file.c_str());
+}
+
+}  // detail
+}  // v1
+}  // testing
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "GUnit/Detail/ServerUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+#if GUNIT_HAS_FORK
+namespace {
+std::string socket_path() {
+  return "/tmp/gunit_server_" + std::to_string(::getpid());
+}
+
+std::string request(const std::string& path, const std::string& line) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address))) {
+    ::close(fd);
+    return "can't connect";
+  }
+  const auto data = line + '\n';
+  write_all(fd, data.data(), data.size());
+  std::string response{};
+  char buffer[256];
+  for (ssize_t n{}; (n = ::read(fd, buffer, sizeof(buffer))) > 0;) {
+    response.append(buffer, std::size_t(n));
+  }
+  ::close(fd);
+  return response;
+}
+}  // namespace
+
+TEST(ServerUtils, ShouldStreamResults) {
+  int fds[2] = {};
+  ASSERT_EQ(0, ::pipe(fds));
+  {
+    result_stream stream{fds[1]};
+    stream.OnTestPartResult(TestPartResult{TestPartResult::kNonFatalFailure,
+                                           "file.cpp", 42, "a\\b\nc"});
+    stream.OnTestPartResult(
+        TestPartResult{TestPartResult::kSuccess, "file.cpp", 1, "ok"});
+    stream.OnTestProgramEnd(*UnitTest::GetInstance());
+  }
+  ::close(fds[1]);
+  std::string lines{};
+  char buffer[256];
+  for (ssize_t n{}; (n = ::read(fds[0], buffer, sizeof(buffer))) > 0;) {
+    lines.append(buffer, std::size_t(n));
+  }
+  ::close(fds[0]);
+  EXPECT_EQ(0u, lines.find("FAILURE file.cpp:42 a\\\\b\\nc\nEND "));
+}
+
+TEST(ServerUtils, ShouldRunRequestsInChildProcesses) {
+  const auto path = socket_path();
+  server s{path};
+  ASSERT_TRUE(s.is_listening());
+
+  std::string passed{}, crashed{}, stopped{};
+  std::thread client{[&] {
+    passed = request(path, "Suite.Test");
+    crashed = request(path, "crash");
+    stopped = request(path, "quit");
+  }};
+
+  std::string filter{};
+  while (s.next(filter)) {  // child process
+    if (filter == "crash") {
+      ::kill(::getpid(), SIGKILL);
+    }
+    const auto response = "END 1 0 " + filter + '\n';
+    write_all(s.client(), response.data(), response.size());
+    ::_exit(0);
+  }
+  client.join();
+
+  EXPECT_EQ("END 1 0 Suite.Test\n", passed);
+  EXPECT_EQ("CRASHED " + std::to_string(SIGKILL) + '\n', crashed);
+  EXPECT_EQ("", stopped);
+}
+
+TEST(ServerUtils, ShouldNotListenOnInvalidPath) {
+  server s{"/nonexistent/directory/socket"};
+  EXPECT_FALSE(s.is_listening());
+  std::string filter{};
+  EXPECT_FALSE(s.next(filter));
+}
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "GUnit/Detail/StatsUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(StatsUtils, ShouldMeasureResourceUsage) {
+  const auto start = current_usage();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  const auto s = make_section_stats("test", "should", start, current_usage());
+  EXPECT_EQ(std::string{"test"}, s.test);
+  EXPECT_EQ(std::string{"should"}, s.should);
+  EXPECT_TRUE(s.wall >= std::chrono::milliseconds(1));
+  EXPECT_TRUE(s.cpu >= std::chrono::nanoseconds{});
+  EXPECT_TRUE(s.max_rss_delta_kb >= 0);
+}
+
+TEST(StatsUtils, ShouldParseCsvStats) {
+  const section_stats s{"suite.test", "return \"x\", y",
+                        std::chrono::nanoseconds{42},
+                        std::chrono::nanoseconds{7}, 2, 3, 4};
+  section_stats parsed{};
+  EXPECT_TRUE(stats_report::parse(stats_report::csv(s), parsed));
+  EXPECT_EQ(s.test, parsed.test);
+  EXPECT_EQ(s.should, parsed.should);
+  EXPECT_EQ(42, parsed.wall.count());
+  EXPECT_EQ(7, parsed.cpu.count());
+  EXPECT_EQ(2, parsed.max_rss_delta_kb);
+  EXPECT_EQ(3u, parsed.allocations);
+  EXPECT_EQ(4u, parsed.allocated_bytes);
+
+  EXPECT_FALSE(stats_report::parse("\"a\",1", parsed));
+}
+
+TEST(StatsUtils, ShouldRecordStatsOnlyWhenEnabled) {
+  const section_stats s{"test", "should"};
+
+  stats_report disabled{""};
+  disabled.record(s);
+  EXPECT_TRUE(disabled.sections().empty());
+
+  stats_report printed{"1"};
+  printed.record(s);
+  EXPECT_TRUE(printed.is_printed());
+  EXPECT_EQ(1u, printed.sections().size());
+}
+
+TEST(StatsUtils, ShouldSaveJsonReport) {
+  const auto file = std::string{::testing::TempDir()} + "StatsUtils.json";
+  {
+    stats_report report{file};
+    report.record({"test", "say \"hi\"", std::chrono::nanoseconds{1}});
+    report.save();
+  }
+  std::ifstream in{file};
+  std::stringstream json{};
+  json << in.rdbuf();
+  EXPECT_EQ(std::string{R"({
+  "sections": [
+    {"test": "test", "should": "say \"hi\"", "wall_ns": 1, "cpu_ns": 0, "max_rss_delta_kb": 0, "allocations": 0, "allocated_bytes": 0}
+  ]
+}
+)"},
+            json.str());
+  std::remove(file.c_str());
+}
+
+}  // detail
+}  // v1
+}  // testing
@@ -45,6 +45,31 @@ TEST(StringUtils, ShouldMakeString) {
                    decltype(
                        make_string<String, sizeof("abcd")>::type())>::value,
       "");
+
+#if GUNIT_HAS_FIXED_STRING
+  static_assert(std::is_same<string<'a', 'b', 'c', 'd', 0>,
+                             make_string_t<"abcd">>::value,
+                "");
+#endif
+}
+
+TEST(StringUtils, ShouldMakeLongString) {
+#define STR16 "0123456789abcdef"
+#define STR256 \
+  STR16 STR16 STR16 STR16 STR16 STR16 STR16 STR16 STR16 STR16 STR16 STR16 \
+  STR16 STR16 STR16 STR16
+#define STR2048 STR256 STR256 STR256 STR256 STR256 STR256 STR256 STR256
+  struct String {
+    const char* chrs = STR2048;
+  };
+
+  using str_t = make_string<String, sizeof(STR2048)>::type;
+  EXPECT_EQ(sizeof(STR2048) - 1, std::string{str_t::c_str()}.size());
+  EXPECT_STREQ(STR2048, str_t::c_str());
+  EXPECT_STREQ(STR2048, decltype(STR2048 ""_gtest_string)::c_str());
+#undef STR2048
+#undef STR256
+#undef STR16
 }
 
 TEST(StringUtils, ShouldReturnTrimmedString) {
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "GUnit/Detail/TermUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+namespace {
+class synced_buf : public std::stringbuf {
+ public:
+  int syncs = 0;
+
+ private:
+  int sync() override {
+    ++syncs;
+    return std::stringbuf::sync();
+  }
+};
+}  // namespace
+
+TEST(TermUtils, ShouldKeepProgressLinesBuffered) {
+  print_progress("");  // starts the flush interval
+  synced_buf buf{};
+  auto* const out = std::cout.rdbuf(&buf);
+
+  print_progress("DISABLED", "name", true);
+  print_progress("SHOULD", "name");
+  print_progress("step\n");
+
+  std::cout.rdbuf(out);
+  EXPECT_EQ(0, buf.syncs);
+  EXPECT_NE(std::string::npos, buf.str().find("    name\n"));
+  EXPECT_NE(std::string::npos, buf.str().find("step\n"));
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(TermUtils, ShouldFlushProgressLinesOnCrash) {
+  int fds[2]{};
+  ASSERT_EQ(0, ::pipe(fds));
+  std::fflush(nullptr);
+  const auto pid = ::fork();
+  ASSERT_LE(0, pid);
+  if (!pid) {
+    ::dup2(fds[1], 1);
+    print_progress("SHOULD", "crash");
+    std::abort();
+  }
+  ::close(fds[1]);
+  std::string output{};
+  char buf[256]{};
+  for (auto n = ::read(fds[0], buf, sizeof(buf)); n > 0;
+       n = ::read(fds[0], buf, sizeof(buf))) {
+    output.append(buf, n);
+  }
+  ::close(fds[0]);
+  int status{};
+  ::waitpid(pid, &status, 0);
+
+  EXPECT_TRUE(WIFSIGNALED(status));
+  EXPECT_NE(std::string::npos, output.find("    crash\n"));
+}
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "GUnit/Detail/TimeUtils.h"
+
+#if GUNIT_HAS_FORK
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(TimeUtils, ShouldFormatDuration) {
+  EXPECT_EQ(std::string{"42.000 ns"},
+            format_duration(std::chrono::nanoseconds{42}));
+  EXPECT_EQ(std::string{"1.500 us"},
+            format_duration(std::chrono::nanoseconds{1500}));
+  EXPECT_EQ(std::string{"2.000 ms"},
+            format_duration(std::chrono::milliseconds{2}));
+  EXPECT_EQ(std::string{"3.000 s"}, format_duration(std::chrono::seconds{3}));
+}
+
+TEST(TimeUtils, ShouldIgnoreDisabledBaseline) {
+  baseline b{""};
+  EXPECT_FALSE(b.is_enabled());
+  EXPECT_EQ(0, b.check("file:1", std::chrono::nanoseconds{42}).count());
+}
+
+TEST(TimeUtils, ShouldRecordAndCompareBaseline) {
+  const auto file = std::string{::testing::TempDir()} + "TimeUtils.baseline";
+  std::remove(file.c_str());
+  {
+    baseline b{file, 5.};
+    EXPECT_TRUE(b.is_enabled());
+    EXPECT_EQ(5., b.tolerance());
+    EXPECT_EQ(0, b.check("file:1", std::chrono::nanoseconds{100}).count());
+    EXPECT_EQ(100, b.check("file:1", std::chrono::nanoseconds{200}).count());
+  }
+  {
+    baseline b{file};
+    EXPECT_EQ(100, b.check("file:1", std::chrono::nanoseconds{300}).count());
+    EXPECT_EQ(0, b.check("file:2", std::chrono::nanoseconds{400}).count());
+  }
+  {
+    baseline b{file, 10., true};
+    EXPECT_EQ(0, b.check("file:1", std::chrono::nanoseconds{50}).count());
+  }
+
+  std::ifstream in{file};
+  std::string line{};
+  ASSERT_TRUE(std::getline(in, line));
+  EXPECT_EQ(std::string{"50 file:1"}, line);
+  ASSERT_TRUE(std::getline(in, line));
+  EXPECT_EQ(std::string{"400 file:2"}, line);
+  EXPECT_FALSE(std::getline(in, line));
+  std::remove(file.c_str());
+}
+
+#if GUNIT_HAS_FORK
+TEST(TimeUtils, ShouldMergeBaselinesOfConcurrentProcesses) {
+  const auto file = std::string{::testing::TempDir()} + "TimeUtils.merge";
+  std::remove(file.c_str());
+  constexpr auto processes = 8;
+  constexpr auto entries = 50;
+
+  std::vector<pid_t> children{};
+  for (auto p = 0; p < processes; ++p) {
+    const auto pid = ::fork();
+    ASSERT_NE(-1, pid);
+    if (!pid) {
+      baseline b{file};
+      for (auto e = 0; e < entries; ++e) {
+        b.check(std::to_string(p) + ":" + std::to_string(e),
+                std::chrono::nanoseconds{e});
+      }
+      _exit(0);
+    }
+    children.push_back(pid);
+  }
+  for (const auto pid : children) {
+    ::waitpid(pid, nullptr, 0);
+  }
+
+  std::ifstream in{file};
+  auto lines = 0;
+  for (std::string line{}; std::getline(in, line);) {
+    ++lines;
+  }
+  EXPECT_EQ(processes * entries, lines);
+  std::remove(file.c_str());
+  std::remove((file + ".lock").c_str());
+}
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
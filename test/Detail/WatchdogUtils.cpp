@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gmock/gmock.h>  // HasSubstr
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "GUnit/Detail/WatchdogUtils.h"
+
+namespace testing {
+inline namespace v1 {
+namespace detail {
+
+TEST(WatchdogUtils, ShouldReportExpiredGuards) {
+  std::promise<std::string> timeout{};
+  hang_watchdog watchdog{
+      [&timeout](const std::string& message) { timeout.set_value(message); }};
+
+  const auto guard = watchdog.arm(std::chrono::milliseconds{10},
+                                  [] { return std::string{" by test"}; });
+  auto message = timeout.get_future();
+  ASSERT_EQ(std::future_status::ready,
+            message.wait_for(std::chrono::seconds{10}));
+
+  const auto result = message.get();
+  EXPECT_EQ(0u, result.find("Timeout of 10 ms exceeded by test"));
+#if GUNIT_HAS_THREAD_STACKS
+  EXPECT_THAT(result, HasSubstr("\nThreads:\n  Thread "));
+#endif
+}
+
+TEST(WatchdogUtils, ShouldNotReportDisarmedGuards) {
+  auto timeouts = 0;
+  {
+    hang_watchdog watchdog{[&timeouts](const std::string&) { ++timeouts; }};
+    watchdog.arm(std::chrono::milliseconds{10}, {});
+    const auto guard = watchdog.arm(std::chrono::seconds{10}, {});
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  }
+  EXPECT_EQ(0, timeouts);
+}
+
+#if GUNIT_HAS_THREAD_STACKS
+TEST(WatchdogUtils, ShouldDumpStacksOfOtherThreads) {
+  std::promise<void> done{};
+  std::thread waiting{[ready = done.get_future()] { ready.wait(); }};
+  const auto stacks = thread_stacks::dump("\n", 32);
+  done.set_value();
+  waiting.join();
+
+  EXPECT_THAT(stacks, HasSubstr("\nThread "));
+  EXPECT_THAT(stacks, Not(HasSubstr("not responding")));
+}
+#endif
+
+}  // namespace detail
+}  // namespace v1
+}  // namespace testing
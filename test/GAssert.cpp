@@ -5,9 +5,30 @@
 // (See accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 //
+#include <gtest/gtest-spi.h>
 #include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <compare>
+#endif
+
 #include "GUnit/GAssert.h"
 
+namespace {
+int evaluations{};
+int evaluated(int value) {
+  ++evaluations;
+  return value;
+}
+}  // namespace
+
 TEST(GAssert, ShouldSupportExpect) {
   auto i = 42;
   const auto b = true;
@@ -74,3 +95,193 @@ TEST(GAssert, ShouldSupportASSERT) {
 
   ASSERT(false or true);
 }
+
+TEST(GAssert, ShouldReportStreamedMessagesOfFailedAssertions) {
+  const auto i = 42;
+  EXPECT_NONFATAL_FAILURE(EXPECT(i == 0) << "message " << i << std::endl,
+                          "Expected equality of these values:\n  i\n    "
+                          "Which is: 42\n  0\nmessage 42\n");
+  EXPECT_FATAL_FAILURE([] { ASSERT(false) << "fatal"; }(), "fatal");
+
+  const std::string str{"24"};
+  EXPECT_NONFATAL_FAILURE(
+      EXPECT("42" == str),
+      "Expected equality of these values:\n  \"42\"\n  str\n    Which is: \"24\"");
+  EXPECT_FATAL_FAILURE([] { ASSERT(1 + 1 > 2); }(),
+                       "Expected: (1 + 1) > (2), actual: 2 vs 2");
+}
+
+TEST(GAssert, ShouldEvaluateNotDecomposableExpressionsAsWhole) {
+  const auto i = 42;
+  const int* null = nullptr;
+  EXPECT(null == nullptr || *null == 42);
+  EXPECT(1 << 3 == 8);
+  EXPECT((i & 2) == 2);
+  EXPECT(i & 2);
+  EXPECT(i == 42 ? true : false);
+  EXPECT(0 < i and i < 100);
+  EXPECT_NONFATAL_FAILURE(EXPECT(i == 0 || i == 1),
+                          "i == 0 || i == 1\n    Which is: false\n  true");
+}
+
+TEST(GAssert, ShouldEvaluateComparisonsOnce) {
+  struct counted {
+    int& comparisons;
+    bool equal;
+    bool operator==(const counted& other) const {
+      ++comparisons;
+      return equal && other.equal;
+    }
+  };
+  struct convertible {
+    int& conversions;
+    explicit operator bool() const { return ++conversions; }
+  };
+
+  auto conversions = 0;
+  EXPECT(convertible{conversions});
+  EXPECT_EQ(1, conversions);
+
+  auto comparisons = 0;
+  const counted equal{comparisons, true};
+  const counted different{comparisons, false};
+  EXPECT(equal == equal);
+  EXPECT_EQ(1, comparisons);
+
+  comparisons = 0;
+  EXPECT_NONFATAL_FAILURE(EXPECT(different == equal),
+                          "Expected equality of these values:\n  different\n");
+  EXPECT_EQ(1, comparisons);
+
+  const auto d = 0.5;
+  const auto one = 1.0;
+  EXPECT_NONFATAL_FAILURE(EXPECT(d == 1), "  d\n    Which is: 0.5\n  1");
+  EXPECT(one == 1 + std::numeric_limits<double>::epsilon());
+  EXPECT(1 == one);
+}
+
+TEST(GAssert, ShouldEvaluateAssertionsOnce) {
+  evaluations = 0;
+  EXPECT_FATAL_FAILURE([] { ASSERT(evaluated(0)); }(), "evaluated(0)");
+  EXPECT_EQ(1, evaluations);
+
+  evaluations = 0;
+  EXPECT_FATAL_FAILURE([] { ASSERT(evaluated(1) == 2) << "message"; }(),
+                       "Which is: 1\n  2\nmessage");
+  EXPECT_EQ(1, evaluations);
+}
+
+TEST(GAssert, ShouldCompareCharArraysByValueAndPointersAsPointers) {
+  const char a[] = "42";
+  const char b[] = "42";
+  const char* pa = a;
+  const char* pb = b;
+  const char* null = nullptr;
+  EXPECT(a == std::string_view{b});
+  EXPECT(b == std::string{"42"});
+  EXPECT(pa != pb);
+  EXPECT(null == nullptr);
+  EXPECT(nullptr == null);
+  EXPECT(null != pa);
+  EXPECT_NONFATAL_FAILURE(EXPECT(pa == pb), "  pa\n    Which is: ");
+  EXPECT_NONFATAL_FAILURE(EXPECT(null == pa), "  null\n    Which is: NULL");
+}
+
+#if __cplusplus >= 202002L
+TEST(GAssert, ShouldEvaluateNotComparableOperandsAsWhole) {
+  const auto a = 1;
+  const auto b = 2;
+  EXPECT((a <=> b) < 0);
+  EXPECT_NONFATAL_FAILURE(EXPECT((b <=> a) < 0),
+                          "(b <=> a) < 0\n    Which is: false");
+}
+#endif
+
+TEST(GAssert, ShouldCompareFloatingPointsInTypeOfLhs) {
+  const auto f = 0.1f;
+  EXPECT(f == 0.1);  // as floats, `EXPECT_FLOAT_EQ`
+  EXPECT_NONFATAL_FAILURE(EXPECT(0.1 == f),
+                          "  f\n    Which is: 0.10000000149011612");
+}
+
+TEST(GAssert, ShouldSplitExpressionsAtCompileTime) {
+  using ::testing::detail::expression;
+  constexpr expression eq{"a.size() == std::max(b, c)"};
+  static_assert(eq.lhs(expression::EQ) == "a.size()", "");
+  static_assert(eq.rhs(expression::EQ) == "std::max(b, c)", "");
+  static_assert(eq.decomposable(), "");
+
+  constexpr expression ops{"f(a == b) <= v[i < j] && s != \"<\" and x->y > 1"};
+  static_assert(ops.lhs(expression::EQ) == ops.c_str(), "");
+  static_assert(ops.rhs(expression::EQ).empty(), "");
+  static_assert(ops.lhs(expression::LE) == "f(a == b)", "");
+  static_assert(ops.rhs(expression::NE) == "\"<\" and x->y > 1", "");
+  static_assert(ops.lhs(expression::GT) ==
+                    "f(a == b) <= v[i < j] && s != \"<\" and x->y",
+                "");
+  static_assert(ops.rhs(expression::LT).empty(), "");
+  static_assert(!ops.decomposable(), "");
+
+  constexpr expression shifts{"a << 1 >= b >> 1"};
+  static_assert(shifts.lhs(expression::GE) == "a << 1", "");
+  static_assert(shifts.rhs(expression::GE) == "b >> 1", "");
+  static_assert(shifts.rhs(expression::LT).empty(), "");
+  static_assert(!shifts.decomposable(), "");
+
+  static_assert(expression{"!f(a && b)"}.decomposable(), "");
+  static_assert(expression{"brand == operand"}.decomposable(), "");
+  static_assert(!expression{"a < b < c"}.decomposable(), "");
+  static_assert(!expression{"a ? b : c"}.decomposable(), "");
+  static_assert(!expression{"a |= b"}.decomposable(), "");
+  static_assert(!expression{"a or b"}.decomposable(), "");
+
+  constexpr expression templates{"static_cast<int>(a) >= limits<T>::max()"};
+  static_assert(templates.lhs(expression::GE) == "static_cast<int>(a)", "");
+  static_assert(templates.decomposable(), "");
+  static_assert(!expression{"a<b && c>d"}.decomposable(), "");
+}
+
+TEST(GAssert, ShouldSkipDigitSeparators) {
+  using ::testing::detail::expression;
+  constexpr expression number{"x == 1'000 && c == 'a'"};
+  static_assert(number.rhs(expression::EQ) == "1'000 && c == 'a'", "");
+  static_assert(!number.decomposable(), "");
+
+  constexpr expression hex{"0xff'ff != u8'a'"};
+  static_assert(hex.lhs(expression::NE) == "0xff'ff", "");
+  static_assert(hex.rhs(expression::NE) == "u8'a'", "");
+  static_assert(hex.decomposable(), "");
+
+  const auto x = 1000;
+  EXPECT(x == 1'000);
+  EXPECT_NONFATAL_FAILURE(EXPECT(x == 1'001),
+                          "  x\n    Which is: 1000\n  1'001");
+}
+
+TEST(GAssert, ShouldSupportRangeComparisons) {
+  const std::vector<int> actual{1, 2, 3};
+  EXPECT_RANGE_EQ(actual, (std::array{1, 2, 3}));
+  ASSERT_BYTES_EQ("abc", "abd", 2);
+  EXPECT_NONFATAL_FAILURE(EXPECT_RANGE_EQ(actual, (std::vector{1, 0, 3})),
+                          "First mismatch at index 1:\n");
+  EXPECT_FATAL_FAILURE(ASSERT_BYTES_EQ("abc", "abd", 3),
+                       "First mismatch at byte 2 of 3:\n");
+}
+
+TEST(GAssert, ShouldSupportExpectWithin) {
+  auto runs = 0;
+  EXPECT_WITHIN(std::chrono::seconds{1}) { ++runs; }
+  EXPECT_EQ(5, runs);
+
+  runs = 0;
+  EXPECT_WITHIN(std::chrono::seconds{1}, 3) { ++runs; }
+  EXPECT_EQ(3, runs);
+}
+
+TEST(GAssert, ShouldReportExpectWithinOverBudget) {
+  EXPECT_NONFATAL_FAILURE(
+      EXPECT_WITHIN(std::chrono::microseconds{1}, 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      },
+      "Expected to run within 1.000 us");
+}
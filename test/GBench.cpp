@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "GUnit/GBench.h"
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "GUnit/GMock.h"
+
+TEST(GBench, ShouldCalculateBenchResult) {
+  using namespace testing::detail;
+  const auto result = make_bench_result({4., 1., 3., 2., 10.}, 100);
+  EXPECT_EQ(100u, result.iterations);
+  EXPECT_EQ(5u, result.samples);
+  EXPECT_DOUBLE_EQ(4., result.mean);
+  EXPECT_DOUBLE_EQ(1., result.min);
+  EXPECT_DOUBLE_EQ(3., result.p50);
+  EXPECT_DOUBLE_EQ(10., result.p90);
+  EXPECT_DOUBLE_EQ(10., result.p99);
+  EXPECT_NEAR(3.5355, result.stddev, 1e-4);
+
+  const auto empty = make_bench_result({}, 1);
+  EXPECT_EQ(0u, empty.samples);
+}
+
+TEST(GBench, ShouldCalibrateIterationsAndCollectSamples) {
+  testing::detail::BenchRun br{};
+  br.samples = 3;
+  br.sample_time = std::chrono::milliseconds{1};
+  auto passes = 0;
+  std::size_t iterations{};
+  br.run([&](testing::detail::BenchRun& tr_gtest) {
+    ++passes;
+    iterations = 0;
+    MEASURE { testing::DoNotOptimize(++iterations); }
+  });
+
+  EXPECT_EQ(3u, br.result.samples);
+  EXPECT_EQ(iterations, br.result.iterations);
+  EXPECT_TRUE(iterations > 1);
+  EXPECT_TRUE(passes > 3 + 1);  // calibration, warmup, samples
+  EXPECT_TRUE(br.result.mean > 0.);
+  EXPECT_TRUE(br.result.min <= br.result.p50);
+  EXPECT_TRUE(br.result.p50 <= br.result.p99);
+}
+
+TEST(GBench, ShouldFailWhenNothingIsMeasured) {
+  std::vector<std::string> failures{};
+  {
+    testing::detail::intercept_results intercept{
+        [&](const testing::TestPartResult& result) {
+          failures.push_back(result.message());
+        }};
+    testing::detail::BenchRun br{};
+    br.run([](testing::detail::BenchRun&) {});
+  }
+  ASSERT_EQ(1u, failures.size());
+  EXPECT_EQ(std::string{"GBENCH has to MEASURE the benchmarked code"},
+            failures[0]);
+}
+
+GBENCH("Accumulate") {
+  std::vector<int> data(64, 1);
+  MEASURE { testing::DoNotOptimize(std::accumulate(data.begin(), data.end(), 0)); }
+  EXPECT_EQ(64, std::accumulate(data.begin(), data.end(), 0));
+}
+
+GBENCH("Accumulate", "Sizes", testing::Values(8, 256)) {
+  std::vector<int> data(GetParam(), 1);
+  MEASURE { testing::DoNotOptimize(std::accumulate(data.begin(), data.end(), 0)); }
+}
+
+struct interface {
+  virtual ~interface() = default;
+  virtual int get() const = 0;
+};
+
+class example {
+ public:
+  explicit example(const interface& i) : i(i) {}
+  int twice() const { return i.get() * 2; }
+
+ private:
+  const interface& i;
+};
+
+GBENCH(example, "Should call get") {
+  using namespace testing;
+  EXPECT_CALL(mock<interface>(), (get)()).WillRepeatedly(Return(21));
+  MEASURE { DoNotOptimize(sut->twice()); }
+}
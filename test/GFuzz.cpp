@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "GUnit/GFuzz.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "GUnit/GAssert.h"
+
+namespace {
+int parse(const std::string& input) {
+  auto value = 0;
+  for (const auto c : input) {
+    if (c >= '0' && c <= '9' && value < 100000) {
+      value = value * 10 + (c - '0');
+    }
+  }
+  return value;
+}
+
+bool magic(const std::string& input) {
+  return input.size() >= 4 && input[0] == 'F' && input[1] == 'U' &&
+         input[2] == 'Z' && input[3] == 'Z';
+}
+
+struct point {
+  std::int16_t x{};
+  std::int16_t y{};
+};
+}  // namespace
+
+TEST(GFuzz, ShouldConvertBytesToInputs) {
+  using namespace testing::detail;
+  EXPECT_EQ("ab", fuzz_input<std::string>::make({'a', 'b'}));
+  EXPECT_EQ(0u, fuzz_input<std::string>::size);
+  EXPECT_EQ((std::vector<std::uint8_t>{1, 2}),
+            fuzz_input<std::vector<std::uint8_t>>::make({1, 2}));
+  EXPECT_EQ(sizeof(point), fuzz_input<point>::size);
+  const auto p = fuzz_input<point>::make({1, 0, 2});
+  EXPECT_EQ(1, p.x);
+  EXPECT_EQ(2, p.y);
+}
+
+TEST(GFuzz, ShouldReportMinimizedFailingInput) {
+  testing::detail::FuzzRun<std::string> fr{};
+  fr.options.runs = 1000000;
+  fr.options.corpus = {};
+  std::vector<testing::TestPartResult> results{};
+  {
+    testing::detail::intercept_results intercept{
+        [&results](const testing::TestPartResult& result) {
+          results.push_back(result);
+        },
+        true};
+    fr.run([](testing::detail::FuzzRun<std::string>& tr_gtest) {
+      if (testing::detail::fuzzer::has_coverage()) {
+        EXPECT_FALSE(magic(FUZZ_INPUT));
+      } else {
+        EXPECT_EQ(std::string::npos, FUZZ_INPUT.find('#'));
+      }
+    });
+  }
+  ASSERT_EQ(2u, results.size());
+  const std::string message = results[0].message();
+  EXPECT_NE(std::string::npos, message.find("GFUZZ failed after"));
+  EXPECT_NE(std::string::npos,
+            message.find(testing::detail::fuzzer::has_coverage()
+                             ? "Input: \"FUZZ\" (minimized"
+                             : "Input: \"#\" (minimized"));
+  EXPECT_TRUE(results[1].failed());
+}
+
+TEST(GFuzz, ShouldReportExceptionsAsFailures) {
+  testing::detail::FuzzRun<std::uint8_t> fr{};
+  std::vector<testing::TestPartResult> results{};
+  {
+    testing::detail::intercept_results intercept{
+        [&results](const testing::TestPartResult& result) {
+          results.push_back(result);
+        },
+        true};
+    fr.run([](testing::detail::FuzzRun<std::uint8_t>& tr_gtest) {
+      if (FUZZ_INPUT > 200) {
+        throw std::runtime_error{"too big"};
+      }
+    });
+  }
+  ASSERT_EQ(2u, results.size());
+  EXPECT_NE(std::string::npos, std::string{results[0].message()}.find(
+                                   "minimized from 1 to 1 bytes"));
+  EXPECT_NE(std::string::npos,
+            std::string{results[1].message()}.find("too big"));
+}
+
+GFUZZ("Parse", std::string) {
+  const auto value = parse(FUZZ_INPUT);
+  EXPECT(value >= 0);
+  EXPECT(value < 1000000);
+}
+
+GFUZZ("Point", point) {
+  const auto& p = FUZZ_INPUT;
+  EXPECT(long(p.x) * p.x + long(p.y) * p.y >= 0);
+}
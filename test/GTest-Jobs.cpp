@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "GUnit/GTest.h"
+
+// run with GUNIT_JOBS=2
+
+namespace {
+bool environment = false;
+
+class user_environment : public testing::Environment {
+ public:
+  void SetUp() override { environment = true; }
+};
+
+void fail_fatally_unless(bool condition) { ASSERT_TRUE(condition); }
+}  // namespace
+
+GTEST("Jobs") {
+  SHOULD("run once the environments are set up") { EXPECT_TRUE(environment); }
+
+  SHOULD("see only results of the test") {
+    EXPECT_FALSE(HasFailure());
+    ASSERT_NO_FATAL_FAILURE(fail_fatally_unless(true));
+  }
+}
+
+GTEST("Jobs", "environment") { EXPECT_TRUE(environment); }
+
+GTEST("Jobs", "property") { RecordProperty("worker", "property"); }
+
+int main(int argc, char** argv) {
+  testing::InitGoogleMock(&argc, argv);
+  // added after the runner of the jobs has been installed
+  testing::AddGlobalTestEnvironment(new user_environment);
+  return RUN_ALL_TESTS();
+}
@@ -6,8 +6,16 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "GUnit/GTest.h"
+#include <gtest/gtest-spi.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 TEST(GTest, ShouldCompareTypeId) {
   using namespace testing::detail;
@@ -62,6 +70,330 @@ TEST(GTest, ShouldReturnCtorSize) {
   }
 }
 
+struct sections {
+  static std::vector<std::string>& calls() {
+    static std::vector<std::string> calls{};
+    return calls;
+  }
+
+  static void pass(testing::detail::TestRun& tr_gtest) {
+    calls().push_back("prelude");
+    SHOULD("a") { calls().push_back("a"); }
+    DISABLED_SHOULD("b") { calls().push_back("b"); }
+    for (auto i = 0; i < 2; ++i) {
+      SHOULD("c") { calls().push_back("c"); }
+    }
+    SHOULD("d") { calls().push_back("d"); }
+  }
+};
+
+TEST(GTest, ShouldRunEachSectionOnce) {
+  sections::calls().clear();
+  testing::detail::TestRun tr{};
+  tr.fork_sections = false;
+  tr.threads = 0;
+  tr.run(sections::pass);
+  const std::vector<std::string> expected = {"prelude", "a", "prelude", "c",
+                                             "prelude", "d"};
+  EXPECT_EQ(expected, sections::calls());
+}
+
+TEST(GTest, ShouldRunOnlySectionsMatchingFilter) {
+  sections::calls().clear();
+  testing::detail::TestRun tr{};
+  tr.fork_sections = false;
+  tr.threads = 0;
+  tr.should_filter = std::make_shared<const testing::detail::filter>("d:-a");
+  tr.run(sections::pass);
+  const std::vector<std::string> expected = {"prelude", "d", "prelude"};
+  EXPECT_EQ(expected, sections::calls());
+}
+
+TEST(GTest, ShouldRunSectionsFollowingFatalFailure) {
+  std::vector<std::string> calls{};
+  const auto pass = [&calls](testing::detail::TestRun& tr_gtest) {
+    SHOULD("a") {
+      calls.push_back("a");
+      ASSERT_TRUE(false);
+    }
+    SHOULD("b") { calls.push_back("b"); }
+    SHOULD("c") { calls.push_back("c"); }
+  };
+
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::TestRun tr{};
+    tr.fork_sections = false;
+    tr.threads = 0;
+    tr.run(pass);
+  }
+
+  const std::vector<std::string> expected = {"a", "b", "c"};
+  EXPECT_EQ(expected, calls);
+  EXPECT_EQ(1, results.size());
+}
+
+TEST(GTest, ShouldRunSectionsReachedThroughEarlierSections) {
+  std::vector<std::string> calls{};
+  auto state = 0;
+  const auto pass = [&](testing::detail::TestRun& tr_gtest) {
+    SHOULD("a") { calls.push_back("a"); }
+    SHOULD("b") {
+      calls.push_back("b");
+      state = 1;
+    }
+    if (state) {
+      SHOULD("c") { calls.push_back("c"); }
+    }
+  };
+
+  testing::detail::TestRun tr{};
+  tr.fork_sections = false;
+  tr.threads = 0;
+  tr.run(pass);
+  const std::vector<std::string> expected = {"a", "b", "c"};
+  EXPECT_EQ(expected, calls);
+}
+
+TEST(GTest, ShouldRunSectionsInParallel) {
+  std::atomic<int> preludes{};
+  const auto pass = [&](testing::detail::TestRun& tr_gtest) {
+    ++preludes;
+    SHOULD("a") { ADD_FAILURE() << "a"; }
+    SHOULD("b") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      ADD_FAILURE() << "b";
+    }
+    DISABLED_SHOULD("c") { ADD_FAILURE() << "c"; }
+    SHOULD("d") { throw std::runtime_error{"d"}; }
+    SHOULD("e") { ADD_FAILURE() << "e"; }
+  };
+
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{
+        testing::ScopedFakeTestPartResultReporter::INTERCEPT_ALL_THREADS,
+        &results};
+    testing::detail::TestRun tr{};
+    tr.fork_sections = false;
+    tr.threads = 4;
+    tr.run(pass);
+  }
+
+  EXPECT_EQ(4, preludes);
+  std::vector<std::string> messages{};
+  for (auto i = 0; i < results.size(); ++i) {
+    messages.push_back(results.GetTestPartResult(i).message());
+  }
+  std::sort(messages.begin(), messages.end());
+  ASSERT_EQ(4u, messages.size());
+  EXPECT_THAT(messages[0],
+              testing::HasSubstr("\"d\" thrown in the section"));
+  EXPECT_EQ("Failed\na", messages[1]);
+  EXPECT_EQ("Failed\nb", messages[2]);
+  EXPECT_EQ("Failed\ne", messages[3]);
+}
+
+namespace lazy {
+std::vector<int> params() { return {1, 2, 3, 4, 5, 6}; }
+
+auto throwing_params() {
+  return testing::Generate([i = 0]() mutable -> std::optional<int> {
+    if (++i > 2) {
+      throw std::runtime_error{"source"};
+    }
+    return i;
+  });
+}
+
+void pass(testing::detail::LazyParamRun<&params>& tr_gtest) {
+  if (LAZY_PARAM % 2) {
+    ADD_FAILURE() << "odd";
+  }
+  if (LAZY_PARAM == 4) {
+    throw std::runtime_error{"four"};
+  }
+}
+}  // namespace lazy
+
+TEST(GTest, ShouldReportFailuresPerLazyParameter) {
+  for (const auto threads : {0u, 3u}) {
+    testing::TestPartResultArray results{};
+    {
+      testing::ScopedFakeTestPartResultReporter reporter{
+          testing::ScopedFakeTestPartResultReporter::INTERCEPT_ALL_THREADS,
+          &results};
+      testing::detail::LazyParamRun<&lazy::params> tr{};
+      tr.threads = threads;
+      tr.run(lazy::pass);
+    }
+
+    ASSERT_EQ(4, results.size());
+    EXPECT_STREQ("Parameter #0 (1)\nFailed\nodd",
+                 results.GetTestPartResult(0).message());
+    EXPECT_STREQ("Parameter #2 (3)\nFailed\nodd",
+                 results.GetTestPartResult(1).message());
+    EXPECT_THAT(results.GetTestPartResult(2).message(),
+                testing::HasSubstr("Parameter #3 (4)\nC++ exception with "
+                                   "description \"four\" thrown"));
+    EXPECT_STREQ("Parameter #4 (5)\nFailed\nodd",
+                 results.GetTestPartResult(3).message());
+  }
+}
+
+TEST(GTest, ShouldReportLazyParameterFailuresAsTheyHappen) {
+  testing::TestPartResultArray results{};
+  std::vector<int> reported{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::LazyParamRun<&lazy::params> tr{};
+    tr.threads = 0;
+    tr.run([&](auto& tr_gtest) {
+      reported.push_back(results.size());
+      if (LAZY_PARAM == 2) {
+        ADD_FAILURE() << "two";
+      }
+    });
+  }
+
+  const std::vector<int> expected = {0, 0, 1, 1, 1, 1};
+  EXPECT_EQ(expected, reported);
+}
+
+TEST(GTest, ShouldReportLazyParameterSourceFailures) {
+  auto runs = 0;
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::LazyParamRun<&lazy::throwing_params> tr{};
+    tr.threads = 0;
+    tr.run([&runs](auto&) { ++runs; });
+  }
+
+  EXPECT_EQ(2, runs);
+  ASSERT_EQ(1, results.size());
+  EXPECT_THAT(results.GetTestPartResult(0).message(),
+              testing::HasSubstr("\"source\" thrown by the parameters"));
+}
+
+#if GUNIT_HAS_FORK
+TEST(GTest, ShouldRunPreludeOnceAndSectionsInChildProcesses) {
+  sections::calls().clear();
+  testing::detail::TestRun tr{};
+  tr.fork_sections = true;
+  tr.run(sections::pass);
+  const std::vector<std::string> expected = {"prelude"};
+  EXPECT_EQ(expected, sections::calls());
+}
+
+TEST(GTest, ShouldReportChildProcessFailures) {
+  const auto pass = [](testing::detail::TestRun& tr_gtest) {
+    SHOULD("fail") { EXPECT_EQ(1, 2); }
+    SHOULD("throw") { throw std::runtime_error{"error"}; }
+    SHOULD("crash") { std::abort(); }
+    EXPECT_TRUE(false) << "runs in every child";
+  };
+
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::TestRun tr{};
+    tr.fork_sections = true;
+    tr.run(pass);
+  }
+
+  ASSERT_EQ(4, results.size());
+  EXPECT_TRUE(results.GetTestPartResult(0).nonfatally_failed());
+  EXPECT_TRUE(results.GetTestPartResult(1).nonfatally_failed());
+  EXPECT_THAT(results.GetTestPartResult(1).message(),
+              testing::HasSubstr("runs in every child"));
+  EXPECT_THAT(results.GetTestPartResult(2).message(),
+              testing::HasSubstr("\"error\" thrown in the section"));
+  EXPECT_THAT(results.GetTestPartResult(3).message(),
+              testing::HasSubstr("\"crash\" crashed with signal"));
+}
+
+TEST(GTest, ShouldReportSectionsSkippedByParentProcessFailures) {
+  std::vector<std::string> calls{};
+  const auto pass = [&calls](testing::detail::TestRun& tr_gtest) {
+    SHOULD("a") {}
+    ASSERT_TRUE(false);
+    SHOULD("b") {}
+    calls.push_back("parent");
+  };
+
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::TestRun tr{};
+    tr.fork_sections = true;
+    tr.run(pass);
+  }
+
+  EXPECT_TRUE(calls.empty());
+  ASSERT_EQ(2, results.size());
+  EXPECT_TRUE(results.GetTestPartResult(0).fatally_failed());
+  EXPECT_THAT(results.GetTestPartResult(1).message(),
+              testing::HasSubstr("following the section \"a\""));
+  EXPECT_THAT(results.GetTestPartResult(1).message(),
+              testing::HasSubstr("skipped"));
+}
+
+TEST(GTest, ShouldRecordPropertiesOfChildProcesses) {
+  const auto pass = [](testing::detail::TestRun& tr_gtest) {
+    SHOULD("record") { RecordProperty("child", "property"); }
+  };
+
+  testing::detail::TestRun tr{};
+  tr.fork_sections = true;
+  tr.run(pass);
+
+  const auto& result =
+      *testing::UnitTest::GetInstance()->current_test_info()->result();
+  ASSERT_EQ(1, result.test_property_count());
+  EXPECT_STREQ("child", result.GetTestProperty(0).key());
+  EXPECT_STREQ("property", result.GetTestProperty(0).value());
+}
+
+struct notification {
+  virtual ~notification() = default;
+  virtual void notify(int) = 0;
+};
+
+TEST(GTest, ShouldFailHungSectionsInChildProcesses) {
+  const auto pass = [](testing::detail::TestRun& tr_gtest) {
+    SHOULD("hang") {
+      testing::StrictGMock<notification> n{};
+      EXPECT_CALL(n, (notify)(42));
+      std::this_thread::sleep_for(std::chrono::seconds(10));
+    }
+    SHOULD("pass") {}
+  };
+
+  testing::TestPartResultArray results{};
+  {
+    testing::ScopedFakeTestPartResultReporter reporter{&results};
+    testing::detail::TestRun tr{};
+    tr.fork_sections = true;
+    tr.timeout = std::chrono::milliseconds{100};
+    tr.run(pass);
+  }
+
+  ASSERT_EQ(2, results.size());
+  const std::string message = results.GetTestPartResult(0).message();
+  EXPECT_THAT(message, testing::HasSubstr("Timeout of 100 ms exceeded by "
+                                          "\"GTest.ShouldFailHungSectionsIn"
+                                          "ChildProcesses\", SHOULD \"hang\""));
+  EXPECT_THAT(message, testing::HasSubstr("\nOutstanding expectations:\n  "));
+  EXPECT_THAT(message, testing::HasSubstr(
+                           "EXPECT_CALL(n, (notify)(42)) - never called, "
+                           "expected: called once"));
+  EXPECT_THAT(results.GetTestPartResult(1).message(),
+              testing::HasSubstr("\"hang\" exited with code 1"));
+}
+#endif
+
 struct interface {
   virtual ~interface() = default;
   virtual int get(int) const = 0;
@@ -909,6 +1241,25 @@ GTEST(example, "[AdditionalValues]", testing::Values(4, 5, 6)) {
   }
 }
 
+GTEST_LAZY(example, "[Lazy]", testing::Range(1, 100)) {
+  using namespace testing;
+  ASSERT_TRUE(nullptr == sut.get());
+
+  std::tie(sut, mocks) = make<SUT, StrictGMock>(LAZY_PARAM);
+  EXPECT_EQ(LAZY_PARAM, sut->get_data());
+}
+
+GTEST_LAZY("LazyTest", "[Generate]",
+           testing::Generate([i = 0]() mutable -> std::optional<int> {
+             return i < 3 ? std::optional<int>{i++} : std::nullopt;
+           })) {
+  EXPECT_TRUE(LAZY_PARAM >= 0 && LAZY_PARAM < 3);
+}
+
+DISABLED_GTEST_LAZY("LazyTest", "[Disabled]", testing::Range(0, 1)) {
+  EXPECT_TRUE(false);
+}
+
 GTEST("Test1") {}
 GTEST("Test1", "Desc1") {}
 GTEST("Test1", "Desc2") {}
@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2016-2017 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+import gunit;
+
+namespace {
+
+class interface {
+ public:
+  virtual int get(int) const = 0;
+  virtual ~interface() = default;
+};
+
+class example {
+ public:
+  explicit example(const interface& i) : i(i) {}
+  int run() const { return i.get(42); }
+
+ private:
+  const interface& i;
+};
+
+}  // namespace
+
+int main() {
+  testing::NiceGMock<interface> mock{};
+  example sut{testing::object(mock)};
+  return sut.run();
+}